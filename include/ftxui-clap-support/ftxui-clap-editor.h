@@ -6,12 +6,34 @@
 #ifndef CLAP_FTXUI_SUPPORT_FTXUI_CLAP_EDITOR_H
 #define CLAP_FTXUI_SUPPORT_FTXUI_CLAP_EDITOR_H
 
+#include "clap/events.h"
 #include "clap/ext/gui.h"
 #include "clap/ext/timer-support.h"
+#include "clap/host.h"
 #include <ftxui/component/component.hpp>
 #include <ftxui/component/event.hpp>
+#include <atomic>
 #include <memory>
 
+/// @brief One parameter change delivered to the editor
+struct ftxui_clap_param_change {
+  clap_id param_id;
+  double value;
+};
+
+/// @brief A parameter edit made in the UI, on its way to the audio thread
+struct ftxui_clap_param_edit {
+  enum kind_t : uint32_t {
+    value_change,  ///< The parameter was set to value
+    gesture_begin, ///< The user started adjusting the parameter
+    gesture_end,   ///< The user finished adjusting the parameter
+  };
+
+  kind_t kind;
+  clap_id param_id;
+  double value; ///< Only meaningful for value_change
+};
+
 /// @brief Base class for FTXUI-based CLAP plugin editors
 ///
 /// This class provides the interface between CLAP plugin GUIs and the FTXUI
@@ -21,7 +43,11 @@
 /// Unlike ImGui's immediate mode approach, FTXUI uses a retained component
 /// model where the UI is built once and then updated through data binding.
 struct ftxui_clap_editor {
-  virtual ~ftxui_clap_editor() = default;
+  ftxui_clap_editor() = default;
+  virtual ~ftxui_clap_editor();
+
+  ftxui_clap_editor(const ftxui_clap_editor &) = delete;
+  ftxui_clap_editor &operator=(const ftxui_clap_editor &) = delete;
 
   /// @brief Called when the GUI is created by the host
   /// Override this to perform any initialization needed for your UI
@@ -48,8 +74,23 @@ struct ftxui_clap_editor {
   /// @brief Called periodically to allow parameter updates from the audio
   /// thread Override this to poll parameter changes and update your UI
   /// components
+  /// @note Also called on its own when parameter updates had to be dropped,
+  ///       in which case the editor should re-read all of its parameters
   virtual void onParameterUpdate() {}
 
+  /// @brief Called at most once per frame with the parameters that changed
+  /// since the previous call
+  /// Each parameter normally appears once, with its latest value; ids beyond
+  /// ftxui_clap_terminal_options::parameter_capacity may appear several
+  /// times, oldest first. Override this to update only what moved. The
+  /// default implementation calls onParameterUpdate().
+  /// @param changes Changed parameters, valid for the duration of the call
+  /// @param count Number of entries in changes
+  virtual void onParameterChanges(const ftxui_clap_param_change * /*changes*/,
+                                  size_t /*count*/) {
+    onParameterUpdate();
+  }
+
   /// @brief Get preferred terminal dimensions for this editor
   /// Override this to specify the ideal size for your plugin's terminal UI
   /// @param cols Reference to store preferred column count
@@ -89,6 +130,12 @@ struct ftxui_clap_editor {
   /// This is managed internally by the clap-ftxui-support library
   /// and should not be accessed directly by plugin code
   void *ctx{nullptr};
+
+  /// @brief Parameter values and edits shared with the audio thread
+  /// Managed internally like ctx. Created with the first GUI and kept until
+  /// the editor is destroyed, so that audio-thread updates never race with
+  /// the GUI being closed.
+  std::atomic<void *> parameters{nullptr};
 };
 
 /// @brief Configuration options for the FTXUI terminal renderer
@@ -109,12 +156,32 @@ struct ftxui_clap_terminal_options {
   bool enable_unicode = true;
 
   /// Performance tuning
+  /// Maximum frame rate for this editor; requested frames are paced to it
   int target_fps = 30;
+  /// Only render when parameters, input, size or an explicit redraw request
+  /// changed the editor. Disable for animated UIs that read state directly
+  /// in their renderers; the editor is then redrawn at target_fps while
+  /// visible.
   bool use_dirty_tracking = true;
+  /// Delay between the first change to an idle editor and its frame, so that
+  /// a burst of changes (automation, a flurry of events) merges into one
+  /// frame. Changes after that are paced to target_fps.
+  float coalescing_window_ms = 2.0f;
+  /// Number of distinct parameter ids whose latest values are kept for the
+  /// UI. Updates for parameters beyond this still reach the editor, but are
+  /// no longer coalesced. Only used when the editor's first GUI is created.
+  int parameter_capacity = 1024;
 
   /// Font preferences (may be ignored if not supported by host)
   const char *preferred_font_family = "monospace";
   int preferred_font_size = 12;
+
+  /// Host used to register a timer with the timer support interface passed
+  /// to ftxui_clap_guiCreateWith(). When both are available the editor is
+  /// rendered on the host's main thread from ftxui_clap_guiOnTimerWith() and
+  /// no render thread is started for it. The timer is only registered while
+  /// the GUI is shown.
+  const clap_host_t *host = nullptr;
 };
 
 // Core API functions for CLAP integration
@@ -122,7 +189,9 @@ struct ftxui_clap_terminal_options {
 
 /// @brief Create and initialize the FTXUI-based GUI
 /// @param editor Pointer to the plugin's ftxui_clap_editor instance
-/// @param timer Host timer support interface (optional, may be nullptr)
+/// @param timer Host timer support interface (optional, may be nullptr). Used
+/// together with ftxui_clap_terminal_options::host to render on the host's
+/// timer instead of a private render thread.
 /// @param options Configuration options for the terminal renderer (optional)
 /// @return true if the GUI was successfully created
 bool ftxui_clap_guiCreateWith(
@@ -153,15 +222,160 @@ bool ftxui_clap_guiSetSizeWith(ftxui_clap_editor *editor, int width,
                                int height);
 
 /// @brief Show the GUI (make it visible)
+///
+/// The first shown editor opens the display connection, loads fonts and
+/// starts the render thread; nothing is acquired before that.
 /// @param editor Pointer to the plugin's ftxui_clap_editor instance
 /// @return true if the GUI was successfully shown
 bool ftxui_clap_guiShowWith(ftxui_clap_editor *editor);
 
 /// @brief Hide the GUI (make it invisible but don't destroy it)
+///
+/// Hiding the last shown editor stops the render thread and releases the
+/// display connection until an editor is shown again.
 /// @param editor Pointer to the plugin's ftxui_clap_editor instance
 /// @return true if the GUI was successfully hidden
 bool ftxui_clap_guiHideWith(ftxui_clap_editor *editor);
 
+/// @brief Forward a host timer tick to the editor
+/// Call this from the plugin's clap_plugin_timer_support::on_timer(). For
+/// editors in host-timer mode this processes pending updates and renders the
+/// next frame on the calling (main) thread.
+/// @param editor Pointer to the plugin's ftxui_clap_editor instance
+/// @param timer_id Timer identifier passed to on_timer()
+/// @return true if the timer belongs to the editor
+bool ftxui_clap_guiOnTimerWith(ftxui_clap_editor *editor, clap_id timer_id);
+
+/// @brief Mark the editor as changed and request a new frame
+/// The render thread skips editors that have not changed since their last
+/// frame. Call this after modifying state that the UI depends on outside of
+/// parameter updates and input events.
+/// @param editor Pointer to the plugin's ftxui_clap_editor instance
+void ftxui_clap_guiRequestRedrawWith(ftxui_clap_editor *editor);
+
+/// @brief Request a new frame from the audio thread
+/// Call this after changing audio-side state that the UI displays (levels,
+/// playback position, ...). Wait-free and allocation-free; it bumps a
+/// per-editor counter that the render scheduler compares with the last
+/// frame, so idle editors are skipped without any shared lock.
+/// @param editor Pointer to the plugin's ftxui_clap_editor instance
+void ftxui_clap_audioRequestRedrawWith(ftxui_clap_editor *editor);
+
+/// @brief Deliver an input event to the editor
+/// The event is dispatched on the render thread, first to
+/// ftxui_clap_editor::onEvent() and then to the component tree if the
+/// editor did not handle it. A new frame is scheduled afterwards.
+/// @param editor Pointer to the plugin's ftxui_clap_editor instance
+/// @param event The FTXUI event to deliver
+/// @return true if the event was queued
+bool ftxui_clap_guiPostEventWith(ftxui_clap_editor *editor,
+                                 const ftxui::Event &event);
+
+/// @brief Latency percentiles from audio-side changes to the presented frame
+struct ftxui_clap_latency_stats {
+  uint64_t samples = 0;
+  double p50_ms = 0.0;
+  double p90_ms = 0.0;
+  double p99_ms = 0.0;
+  double max_ms = 0.0;
+};
+
+/// @brief Measure how long parameter changes take to reach the screen
+/// Covers the time from a parameter update or audio-side redraw request to
+/// the present of the first frame showing it, across all editors.
+/// Percentiles have a resolution of 0.05 ms.
+/// @param stats Receives the statistics
+/// @return true if any change has been measured since the last reset
+bool ftxui_clap_getChangeLatencyStats(ftxui_clap_latency_stats &stats);
+
+/// @brief Discard the samples behind ftxui_clap_getChangeLatencyStats()
+void ftxui_clap_resetChangeLatencyStats();
+
+/// @brief Number of parameter updates dropped because an editor's
+/// audio-thread queue was full
+/// Queuing a parameter update never blocks the audio thread. When an
+/// editor's queue overflows the newest update is dropped instead, and that
+/// editor receives ftxui_clap_editor::onParameterUpdate() instead of
+/// onParameterChanges() on its next frame to resynchronize.
+/// @return Total number of dropped updates since the library was loaded
+uint64_t ftxui_clap_getDroppedParameterUpdateCount();
+
+/// @brief Set how many threads render editors in parallel
+/// Editors that are due in the same frame have their components rendered
+/// concurrently, while presentation stays on the render thread. A single
+/// editor is never rendered on two threads at once, but state shared
+/// between editor instances must be safe to read concurrently.
+/// Editors driven by a host timer are always rendered on the main thread.
+/// @param count Total render threads including the render thread itself; 0
+/// picks a value from the hardware concurrency, 1 renders serially
+void ftxui_clap_setRenderThreadCount(unsigned count);
+
+/// @brief Start a user gesture (e.g. a slider drag) on a parameter
+/// Value edits made until ftxui_clap_endParameterGestureWith() are reported
+/// to the host as one gesture. Safe to call from any non-audio thread;
+/// never blocks.
+/// @param editor Pointer to the plugin's ftxui_clap_editor instance
+/// @param param_id Parameter being adjusted
+/// @return false if the edit queue is full or the editor has no GUI yet;
+/// the caller may retry on a later frame. A gesture whose begin or end was
+/// dropped and not retried reaches the host unbalanced.
+bool ftxui_clap_beginParameterGestureWith(ftxui_clap_editor *editor,
+                                          clap_id param_id);
+
+/// @brief Queue a parameter value set by the user for the audio thread
+/// Also asks the host to flush parameters when the plugin is not
+/// processing, if the host passed in ftxui_clap_terminal_options::host
+/// supports it. Safe to call from any non-audio thread; never blocks.
+/// @param editor Pointer to the plugin's ftxui_clap_editor instance
+/// @param param_id Parameter that was changed
+/// @param value New plain value of the parameter
+/// @return false if the edit queue is full or the editor has no GUI yet
+bool ftxui_clap_editParameterWith(ftxui_clap_editor *editor, clap_id param_id,
+                                  double value);
+
+/// @brief End a user gesture started with
+/// ftxui_clap_beginParameterGestureWith()
+/// @param editor Pointer to the plugin's ftxui_clap_editor instance
+/// @param param_id Parameter that was being adjusted
+/// @return false if the edit queue is full or the editor has no GUI yet;
+/// retry on a later frame, or the host sees the gesture left open
+bool ftxui_clap_endParameterGestureWith(ftxui_clap_editor *editor,
+                                        clap_id param_id);
+
+/// @brief Take the oldest pending UI edit, on the audio thread
+/// Wait-free and allocation-free. Use this to apply edits to the DSP state
+/// directly; ftxui_clap_flushParameterEditsWith() also reports them.
+/// @param editor Pointer to the plugin's ftxui_clap_editor instance
+/// @param edit Receives the edit
+/// @return false if no edit is pending
+bool ftxui_clap_popParameterEditWith(ftxui_clap_editor *editor,
+                                     ftxui_clap_param_edit &edit);
+
+/// @brief Drain pending UI edits into CLAP output events
+/// Call this from process() or params.flush(). Each edit becomes a
+/// CLAP_EVENT_PARAM_VALUE or CLAP_EVENT_PARAM_GESTURE_BEGIN/END event, and
+/// apply(edit) is invoked for each edit the host accepted so the plugin can
+/// update its own state. Edits the output list rejects are neither applied
+/// nor retried; they are counted by ftxui_clap_getDroppedParameterEditCount().
+/// Wait-free and allocation-free.
+/// @param editor Pointer to the plugin's ftxui_clap_editor instance
+/// @param out Output event list to push to
+/// @param apply Optional callback applying each edit to the plugin, may be
+/// nullptr
+/// @param user_data Passed through to apply
+/// @return Number of edits drained
+uint32_t ftxui_clap_flushParameterEditsWith(
+    ftxui_clap_editor *editor, const clap_output_events_t *out,
+    void (*apply)(void *user_data, const ftxui_clap_param_edit &edit),
+    void *user_data);
+
+/// @brief Number of UI parameter edits that never reached the host
+/// Counts edits dropped because an editor's edit queue was full and edits
+/// the host's output event list rejected in
+/// ftxui_clap_flushParameterEditsWith().
+/// @return Total number of lost edits since the library was loaded
+uint64_t ftxui_clap_getDroppedParameterEditCount();
+
 /// @brief Get the current size of the GUI in pixels
 /// @param editor Pointer to the plugin's ftxui_clap_editor instance
 /// @param width Reference to store the current width in pixels
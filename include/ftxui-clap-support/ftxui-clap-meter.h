@@ -0,0 +1,167 @@
+//
+// ftxui-clap-meter.h
+// CLAP FTXUI Support Library
+//
+
+#ifndef CLAP_FTXUI_SUPPORT_FTXUI_CLAP_METER_H
+#define CLAP_FTXUI_SUPPORT_FTXUI_CLAP_METER_H
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <ftxui/dom/elements.hpp>
+
+/// @brief Lock-free level meter values published by the audio thread
+///
+/// The audio thread publishes per-block peak and RMS levels with a few
+/// relaxed atomic operations and never blocks. The UI takes them once per
+/// frame; the peak is the highest value published since the previous take,
+/// so short transients between two frames are not lost.
+///
+/// Each channel index should be read by a single ftxui_clap_meter.
+struct ftxui_clap_meter_channel {
+  static constexpr int max_channels = 8;
+
+  /// @brief Publish the levels of one audio block (audio thread)
+  /// @param channel Channel index, 0 to max_channels - 1
+  /// @param peak Absolute peak of the block, linear
+  /// @param rms RMS level of the block, linear
+  void publish(int channel, float peak, float rms) {
+    if (channel < 0 || channel >= max_channels)
+      return;
+
+    // Raise the peak with a compare-exchange; a separate load and store
+    // could overwrite a higher peak stored, or a reset made by take(), in
+    // between
+    auto &levels = levels_[channel];
+    float current = levels.peak.load(std::memory_order_relaxed);
+    while (peak > current &&
+           !levels.peak.compare_exchange_weak(current, peak,
+                                              std::memory_order_relaxed)) {
+    }
+    levels.rms.store(rms, std::memory_order_relaxed);
+  }
+
+  /// @brief Compute and publish the levels of a block of samples (audio
+  /// thread)
+  /// @param channel Channel index, 0 to max_channels - 1
+  /// @param samples Block of samples
+  /// @param count Number of samples in the block
+  void publishBlock(int channel, const float *samples, uint32_t count) {
+    if (!samples || count == 0)
+      return;
+
+    float peak = 0.0f;
+    float sum = 0.0f;
+    for (uint32_t i = 0; i < count; ++i) {
+      float sample = samples[i];
+      peak = std::fmax(peak, std::fabs(sample));
+      sum += sample * sample;
+    }
+    publish(channel, peak, std::sqrt(sum / static_cast<float>(count)));
+  }
+
+  /// @brief Take the current levels of a channel (UI thread)
+  /// @param channel Channel index, 0 to max_channels - 1
+  /// @param peak Receives the highest peak since the previous take
+  /// @param rms Receives the most recent RMS level
+  void take(int channel, float &peak, float &rms) {
+    peak = 0.0f;
+    rms = 0.0f;
+    if (channel < 0 || channel >= max_channels)
+      return;
+
+    auto &levels = levels_[channel];
+    peak = levels.peak.exchange(0.0f, std::memory_order_relaxed);
+    rms = levels.rms.load(std::memory_order_relaxed);
+  }
+
+private:
+  // One cache line per channel so that channels published from different
+  // threads do not share one
+  struct alignas(64) channel_levels {
+    std::atomic<float> peak{0.0f};
+    std::atomic<float> rms{0.0f};
+  };
+
+  channel_levels levels_[max_channels];
+};
+
+/// @brief Appearance and ballistics of an ftxui_clap_meter
+struct ftxui_clap_meter_options {
+  /// Level range shown by the meter, in dBFS
+  float min_db = -60.0f;
+  float max_db = 6.0f;
+
+  /// Levels from warn_db are drawn in warn_color, from clip_db in clip_color
+  float warn_db = -12.0f;
+  float clip_db = -3.0f;
+  ftxui::Color normal_color = ftxui::Color::Green;
+  ftxui::Color warn_color = ftxui::Color::Yellow;
+  ftxui::Color clip_color = ftxui::Color::Red;
+
+  /// How fast the bar falls when the level drops
+  float decay_db_per_second = 24.0f;
+
+  /// How long the peak marker stays at the highest peak
+  float peak_hold_seconds = 1.5f;
+
+  /// Fill bottom-up instead of left to right
+  bool vertical = false;
+};
+
+/// @brief RMS level meter with peak hold, drawn with eighth-block
+/// characters for sub-cell resolution
+///
+/// Call render() from a Renderer once per frame; it takes the newest levels
+/// from the channel, advances the ballistics and returns the meter element.
+/// The element is created once and reused, so drawing the meter does not
+/// allocate. For the meter to keep moving the audio thread should request
+/// redraws, e.g. with ftxui_clap_audioRequestRedrawWith() after publishing.
+class ftxui_clap_meter {
+public:
+  /// @param channel Channel to read levels from; must outlive the meter
+  /// @param index Channel index within channel
+  /// @param options Appearance and ballistics
+  ftxui_clap_meter(ftxui_clap_meter_channel &channel, int index,
+                   const ftxui_clap_meter_options &options = {});
+
+  // The element refers back to the meter
+  ftxui_clap_meter(const ftxui_clap_meter &) = delete;
+  ftxui_clap_meter &operator=(const ftxui_clap_meter &) = delete;
+
+  /// @brief Take new levels and advance the ballistics
+  void update();
+
+  /// @brief The meter element, showing the state of the last update()
+  ftxui::Element element() const { return element_; }
+
+  /// @brief update() and return the meter element
+  ftxui::Element render() {
+    update();
+    return element_;
+  }
+
+  /// @brief Displayed RMS level in dBFS
+  float levelDb() const { return level_db_; }
+
+  /// @brief Held peak level in dBFS
+  float peakDb() const { return peak_db_; }
+
+  const ftxui_clap_meter_options &options() const { return options_; }
+
+private:
+  ftxui_clap_meter_channel &channel_;
+  int index_;
+  ftxui_clap_meter_options options_;
+
+  float level_db_;
+  float peak_db_;
+  std::chrono::steady_clock::time_point peak_until_{};
+  std::chrono::steady_clock::time_point last_update_{};
+
+  ftxui::Element element_;
+};
+
+#endif // CLAP_FTXUI_SUPPORT_FTXUI_CLAP_METER_H
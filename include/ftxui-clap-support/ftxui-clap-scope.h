@@ -0,0 +1,158 @@
+//
+// ftxui-clap-scope.h
+// CLAP FTXUI Support Library
+//
+
+#ifndef CLAP_FTXUI_SUPPORT_FTXUI_CLAP_SCOPE_H
+#define CLAP_FTXUI_SUPPORT_FTXUI_CLAP_SCOPE_H
+
+#include "ftxui-clap-triple-buffer.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <ftxui/dom/elements.hpp>
+#include <memory>
+#include <vector>
+
+/// @brief Wait-free transport of sample blocks from the audio thread to a
+/// scope view
+///
+/// The audio thread appends samples to a back buffer; every block_size
+/// samples the buffer is published and the audio thread continues in a
+/// fresh one. The UI takes the most recently completed block. The buffers
+/// rotate through an ftxui_clap_triple_buffer, so neither side ever waits
+/// for the other; blocks the UI did not pick up in time are replaced by
+/// newer ones.
+///
+/// Each channel should have one audio-side writer and one UI-side reader.
+class ftxui_clap_scope_channel {
+public:
+  /// @param block_size Samples per published block, i.e. the time span the
+  /// scope shows
+  explicit ftxui_clap_scope_channel(uint32_t block_size = 2048)
+      : block_size_(std::max<uint32_t>(1, block_size)) {
+    for (unsigned i = 0; i < 3; ++i) {
+      auto &buffer = buffers_.slot(i);
+      buffer = std::make_unique<float[]>(block_size_);
+      std::fill(buffer.get(), buffer.get() + block_size_, 0.0f);
+    }
+  }
+
+  ftxui_clap_scope_channel(const ftxui_clap_scope_channel &) = delete;
+  ftxui_clap_scope_channel &
+  operator=(const ftxui_clap_scope_channel &) = delete;
+
+  uint32_t blockSize() const { return block_size_; }
+
+  /// @brief Append samples (audio thread)
+  /// Wait-free and allocation-free.
+  void push(const float *samples, uint32_t count) {
+    while (count > 0) {
+      uint32_t chunk = std::min(count, block_size_ - fill_);
+      std::memcpy(buffers_.back().get() + fill_, samples,
+                  chunk * sizeof(float));
+      samples += chunk;
+      count -= chunk;
+      fill_ += chunk;
+
+      if (fill_ == block_size_) {
+        buffers_.publish();
+        fill_ = 0;
+      }
+    }
+  }
+
+  /// @brief Take the newest completed block (UI thread)
+  /// @return blockSize() samples, or nullptr if no block was completed since
+  /// the previous call. The samples stay valid until the next call.
+  const float *take() {
+    auto block = buffers_.take();
+    return block ? block->get() : nullptr;
+  }
+
+private:
+  const uint32_t block_size_;
+  ftxui_clap_triple_buffer<std::unique_ptr<float[]>> buffers_;
+
+  // Owned by the audio thread
+  uint32_t fill_ = 0;
+};
+
+/// @brief Reduce a block of samples to per-column minimum and maximum
+///
+/// Column c covers samples [c * count / columns, (c + 1) * count / columns).
+/// Vectorized with SSE2 or NEON where available. Columns without samples
+/// (more columns than samples) get the nearest sample.
+/// @param samples Samples to reduce
+/// @param count Number of samples
+/// @param columns Number of output columns
+/// @param mins Receives the minimum of each column
+/// @param maxs Receives the maximum of each column
+void ftxui_clap_decimateMinMax(const float *samples, uint32_t count,
+                               uint32_t columns, float *mins, float *maxs);
+
+/// @brief Appearance of an ftxui_clap_scope
+struct ftxui_clap_scope_options {
+  /// Sample values mapped to the bottom and top of the view
+  float min_value = -1.0f;
+  float max_value = 1.0f;
+
+  /// Braille dots give 2x4 points per cell; block glyphs give 1x2
+  bool braille = true;
+
+  ftxui::Color color = ftxui::Color::Cyan;
+};
+
+namespace ftxui_clap_support {
+class scope_node;
+}
+
+/// @brief Oscilloscope view of an ftxui_clap_scope_channel
+///
+/// Each column of the view shows the range of the samples it covers, so
+/// peaks survive the reduction from thousands of samples to a few hundred
+/// columns. The element is created once and reused; drawing only
+/// allocates when the view's size changes.
+class ftxui_clap_scope {
+public:
+  /// @param channel Channel to read blocks from; must outlive the scope
+  /// @param options Appearance
+  explicit ftxui_clap_scope(ftxui_clap_scope_channel &channel,
+                            const ftxui_clap_scope_options &options = {});
+
+  // The element refers back to the scope
+  ftxui_clap_scope(const ftxui_clap_scope &) = delete;
+  ftxui_clap_scope &operator=(const ftxui_clap_scope &) = delete;
+
+  /// @brief Take the newest block from the channel, if there is one
+  void update();
+
+  /// @brief The scope element, showing the block of the last update()
+  ftxui::Element element() const { return element_; }
+
+  /// @brief update() and return the scope element
+  ftxui::Element render() {
+    update();
+    return element_;
+  }
+
+  const ftxui_clap_scope_options &options() const { return options_; }
+
+private:
+  friend class ftxui_clap_support::scope_node;
+
+  ftxui_clap_scope_channel &channel_;
+  ftxui_clap_scope_options options_;
+
+  // Block being shown, owned by the channel until the next take()
+  const float *block_ = nullptr;
+
+  // Scratch storage reused across frames
+  std::vector<float> mins_;
+  std::vector<float> maxs_;
+  std::vector<uint8_t> dots_;
+
+  ftxui::Element element_;
+};
+
+#endif // CLAP_FTXUI_SUPPORT_FTXUI_CLAP_SCOPE_H
@@ -0,0 +1,132 @@
+//
+// ftxui-clap-spectrum.h
+// CLAP FTXUI Support Library
+//
+
+#ifndef CLAP_FTXUI_SUPPORT_FTXUI_CLAP_SPECTRUM_H
+#define CLAP_FTXUI_SUPPORT_FTXUI_CLAP_SPECTRUM_H
+
+#include <cstdint>
+#include <ftxui/dom/elements.hpp>
+#include <memory>
+
+namespace ftxui_clap_support {
+class spectrum_worker;
+class spectrum_node;
+} // namespace ftxui_clap_support
+
+/// @brief Analysis settings of an ftxui_clap_spectrum_analyzer
+struct ftxui_clap_spectrum_options {
+  /// Samples per FFT; rounded up to a power of two between 64 and 16384
+  uint32_t fft_size = 2048;
+
+  /// New samples between two analyses; 0 for fft_size / 4
+  uint32_t hop_size = 0;
+
+  /// Samples that fit in the audio-to-worker queue; 0 for 4 * fft_size.
+  /// Samples pushed while it is full are dropped.
+  uint32_t queue_size = 0;
+
+  double sample_rate = 48000.0;
+
+  /// Frequency range mapped onto the columns of the view, log-spaced
+  float min_hz = 20.0f;
+  float max_hz = 20000.0f;
+
+  /// Share of the previous level kept per analysis when the level falls,
+  /// 0 for no smoothing
+  float smoothing = 0.7f;
+};
+
+/// @brief Spectrum analysis running off the audio thread
+///
+/// The audio thread pushes samples into a lock-free queue. A worker thread
+/// owned by the analyzer windows them (Hann), runs a vectorized FFT,
+/// smooths the levels and reduces them to log-spaced columns matching the
+/// width of the view. The UI only picks up the finished columns, so neither
+/// the audio thread nor rendering pays for the analysis.
+///
+/// The worker thread starts when the first ftxui_clap_spectrum is attached;
+/// samples pushed before that are ignored, and no analysis runs until the
+/// view has been drawn.
+class ftxui_clap_spectrum_analyzer {
+public:
+  explicit ftxui_clap_spectrum_analyzer(
+      const ftxui_clap_spectrum_options &options = {});
+  ~ftxui_clap_spectrum_analyzer();
+
+  ftxui_clap_spectrum_analyzer(const ftxui_clap_spectrum_analyzer &) = delete;
+  ftxui_clap_spectrum_analyzer &
+  operator=(const ftxui_clap_spectrum_analyzer &) = delete;
+
+  /// @brief Queue samples for analysis (audio thread)
+  /// Wait-free and allocation-free.
+  void push(const float *samples, uint32_t count);
+
+  /// @brief Change the sample rate used to place the columns, e.g. from
+  /// the plugin's activate()
+  void setSampleRate(double sample_rate);
+
+  /// @brief Number of samples dropped because the queue was full
+  uint64_t droppedSamples() const;
+
+private:
+  friend class ftxui_clap_spectrum;
+
+  std::unique_ptr<ftxui_clap_support::spectrum_worker> worker_;
+};
+
+/// @brief Appearance of an ftxui_clap_spectrum
+struct ftxui_clap_spectrum_view_options {
+  /// Level range shown from bottom to top, in dBFS
+  float min_db = -90.0f;
+  float max_db = 0.0f;
+
+  ftxui::Color color = ftxui::Color::Green;
+};
+
+/// @brief Bar display of an ftxui_clap_spectrum_analyzer
+///
+/// Draws one bar per cell with eighth-block characters. The analyzer is
+/// told the view's width and produces exactly that many columns. The
+/// element is created once and reused; drawing does not allocate.
+class ftxui_clap_spectrum {
+public:
+  /// @param analyzer Analyzer to display; must outlive the view
+  /// @param options Appearance
+  explicit ftxui_clap_spectrum(ftxui_clap_spectrum_analyzer &analyzer,
+                               const ftxui_clap_spectrum_view_options &options = {});
+
+  // The element refers back to the view
+  ftxui_clap_spectrum(const ftxui_clap_spectrum &) = delete;
+  ftxui_clap_spectrum &operator=(const ftxui_clap_spectrum &) = delete;
+
+  /// @brief Take the newest analysis, if there is one
+  void update();
+
+  /// @brief The spectrum element, showing the analysis of the last update()
+  ftxui::Element element() const { return element_; }
+
+  /// @brief update() and return the spectrum element
+  ftxui::Element render() {
+    update();
+    return element_;
+  }
+
+  const ftxui_clap_spectrum_view_options &options() const { return options_; }
+
+private:
+  friend class ftxui_clap_support::spectrum_node;
+
+  ftxui_clap_support::spectrum_worker &worker_;
+  ftxui_clap_spectrum_view_options options_;
+
+  // Levels in dB of the analysis being shown, owned by the worker until
+  // the next update() that finds a newer one
+  const float *levels_ = nullptr;
+  int level_count_ = 0;
+
+  ftxui::Element element_;
+};
+
+#endif // CLAP_FTXUI_SUPPORT_FTXUI_CLAP_SPECTRUM_H
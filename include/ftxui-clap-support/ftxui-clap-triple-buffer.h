@@ -0,0 +1,71 @@
+//
+// ftxui-clap-triple-buffer.h
+// CLAP FTXUI Support Library
+//
+
+#ifndef CLAP_FTXUI_SUPPORT_FTXUI_CLAP_TRIPLE_BUFFER_H
+#define CLAP_FTXUI_SUPPORT_FTXUI_CLAP_TRIPLE_BUFFER_H
+
+#include <atomic>
+
+/// @brief Latest-wins triple buffer between one producer and one consumer
+///
+/// The producer fills back() and publishes it; the consumer takes the most
+/// recently published value. Neither side blocks: the three slots rotate
+/// through a single atomic exchange, and a value published again before the
+/// consumer took it is replaced.
+template <typename T> class ftxui_clap_triple_buffer {
+public:
+  /// @brief The slot to fill next (producer)
+  T &back() { return slots_[back_]; }
+
+  /// @brief The last value published, or nullptr before the first
+  /// publish() (producer)
+  /// That slot is only read by the consumer until the next publish(), so
+  /// the producer may compare the next value against it.
+  const T *lastPublished() const {
+    return last_published_ == no_slot ? nullptr : &slots_[last_published_];
+  }
+
+  /// @brief Make back() the newest value (producer)
+  void publish() {
+    last_published_ = back_;
+    unsigned previous =
+        state_.exchange(back_ | fresh_bit, std::memory_order_acq_rel);
+    back_ = previous & index_mask;
+  }
+
+  /// @brief Take the newest value (consumer)
+  /// @return The value, or nullptr if nothing was published since the
+  /// previous call. The value stays valid until the next take().
+  const T *take() {
+    if (!(state_.load(std::memory_order_acquire) & fresh_bit))
+      return nullptr;
+
+    unsigned previous = state_.exchange(front_, std::memory_order_acq_rel);
+    front_ = previous & index_mask;
+    return &slots_[front_];
+  }
+
+  /// @brief Direct access for setting up the slots before use
+  T &slot(unsigned index) { return slots_[index]; }
+
+private:
+  static constexpr unsigned index_mask = 0x3;
+  static constexpr unsigned fresh_bit = 0x4;
+  static constexpr unsigned no_slot = ~0u;
+
+  T slots_[3];
+
+  // Index of the middle slot, plus fresh_bit while it holds an untaken value
+  std::atomic<unsigned> state_{2};
+
+  // Owned by the producer
+  unsigned back_ = 0;
+  unsigned last_published_ = no_slot;
+
+  // Owned by the consumer
+  alignas(64) unsigned front_ = 1;
+};
+
+#endif // CLAP_FTXUI_SUPPORT_FTXUI_CLAP_TRIPLE_BUFFER_H
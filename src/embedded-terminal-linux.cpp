@@ -1,43 +1,197 @@
 #include "embedded-terminal.h"
+#include "software-raster.h"
 
 #ifdef __linux__
 
 #include <X11/Xft/Xft.h>
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#include <X11/extensions/Xrender.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <fontconfig/fontconfig.h>
+#include <ft2build.h>
+#include FT_FREETYPE_H
 #include <memory>
-#include <sstream>
+#include <mutex>
+#include <poll.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <thread>
+#include <unistd.h>
 #include <unordered_map>
+#include <vector>
 
 namespace ftxui_clap_support {
 
-// Linux-specific terminal renderer using X11 and Xft
+// A glyph and the face it comes from
+struct cached_glyph {
+  XftFont *font = nullptr; // nullptr until looked up
+  FT_UInt glyph = 0;
+  Glyph uploaded = 0; // id in the GlyphSet or atlas, 0 until uploaded
+};
+
+// Glyph indices of one face by codepoint, so frames never decode or look up
+// text again. Latin-1, box drawing and block elements, and braille, the
+// characters terminal UIs draw most, live in flat tables; everything else
+// in a hash map.
+struct glyph_cache {
+  XftFont *font = nullptr;
+  cached_glyph latin[0x100];
+  cached_glyph box[0x100];     // U+2500..U+25FF
+  cached_glyph braille[0x100]; // U+2800..U+28FF
+  std::unordered_map<uint32_t, cached_glyph> others;
+
+  cached_glyph *flat_slot(uint32_t codepoint) {
+    if (codepoint < 0x100) {
+      return &latin[codepoint];
+    }
+    if (codepoint - 0x2500u < 0x100) {
+      return &box[codepoint - 0x2500u];
+    }
+    if (codepoint - 0x2800u < 0x100) {
+      return &braille[codepoint - 0x2800u];
+    }
+    return nullptr;
+  }
+
+  // Forget every glyph, keeping the face
+  void reset() {
+    std::fill(std::begin(latin), std::end(latin), cached_glyph{});
+    std::fill(std::begin(box), std::end(box), cached_glyph{});
+    std::fill(std::begin(braille), std::end(braille), cached_glyph{});
+    others.clear();
+  }
+};
+
+// Linux-specific terminal renderer using X11 and Xft.
+//
+// On a local server with MIT-SHM, frames are rasterized on the CPU into a
+// shared-memory image from a glyph atlas and presented with XShmPutImage,
+// so pixels reach the server without passing through the socket.
+// Otherwise, when the server has RENDER, glyphs are rasterized once,
+// uploaded into a retained GlyphSet and composited with one
+// XRenderCompositeText32 call per styled run, so a frame sends little more
+// than glyph ids. Xft drawing remains the fallback.
 class LinuxTerminalRenderer {
 public:
   LinuxTerminalRenderer(Display *display, Window window);
   ~LinuxTerminalRenderer();
 
   bool initialize();
-  void render(const std::string &content);
+  void render(const terminal_frame &frame,
+              const std::vector<damage_span> &damage);
   void resize(int width, int height);
 
+  // Repaint an uncovered area from the back buffer, without a new frame
+  void expose(int x, int y, int width, int height);
+
 private:
+  // Frames arrive on the render thread, resizes on the host thread and
+  // exposures on the event thread
+  std::mutex mutex_;
+
   Display *display_;
   Window window_;
   XftDraw *xft_draw_;
   XftFont *font_;
+  XftFont *bold_font_ = nullptr;
   XftColor text_color_;
   XftColor background_color_;
   GC gc_;
 
+  // Colors allocated for styled runs, by 0xRRGGBB. Looked up once per run;
+  // dropped wholesale if a UI cycles through too many distinct colors.
+  std::unordered_map<uint32_t, XftColor> colors_;
+  static constexpr size_t max_colors_ = 4096;
+
+  // Frames are drawn into this window-sized pixmap and only the damaged
+  // rectangles are copied to the window, so the window never shows a
+  // cleared cell and an expose is served without repainting
+  Pixmap back_buffer_ = 0;
+  int depth_ = 0;
+
+  // False while the pixmap does not hold the presented frame, after it
+  // was (re)created; the next frame is then painted in full
+  bool back_buffer_valid_ = false;
+
   int char_width_ = 8;
   int char_height_ = 16;
   int width_ = 0;
   int height_ = 0;
 
-  void parse_terminal_content(const std::string &content,
-                              std::vector<std::string> &lines);
+  // Glyphs of the regular and bold faces; the bold cache is unused when
+  // there is no separate bold face
+  glyph_cache regular_glyphs_;
+  glyph_cache bold_glyphs_;
+
+  // Faces opened for codepoints the main font lacks, tried in order
+  std::vector<XftFont *> fallback_fonts_;
+  static constexpr size_t max_fallback_fonts_ = 8;
+  static constexpr size_t max_cached_glyphs_ = 65536;
+
+  // Scratch storage reused across frames
+  std::vector<XftGlyphFontSpec> glyph_specs_;
+  std::vector<unsigned int> glyph_ids_;
+  std::vector<unsigned char> glyph_bitmap_;
+  std::vector<XRectangle> damage_rects_;
+  std::vector<damage_span> full_damage_;
+
+  // GlyphSet path; glyph_set_ is 0 when drawing through Xft
+  GlyphSet glyph_set_ = 0;
+  Glyph next_glyph_id_ = 1;
+  XRenderPictFormat *alpha_format_ = nullptr;
+  XRenderPictFormat *window_format_ = nullptr;
+  Picture picture_ = 0; // on back_buffer_
+
+  // Solid source pictures by 0xRRGGBB, created once per color
+  std::unordered_map<uint32_t, Picture> fills_;
+
+  // Shared-memory path; when use_shm_ is set the image replaces the back
+  // buffer pixmap and all drawing happens in raster_
+  bool use_shm_ = false;
+  XImage *shm_image_ = nullptr;
+  XShmSegmentInfo shm_info_ = {};
+  int shm_completion_type_ = 0;
+  int shm_pending_ = 0; // puts whose completion has not been seen yet
+  raster_target raster_;
+  raster_rect raster_clip_;
+  glyph_atlas atlas_;
+
+  bool create_back_buffer();
+  bool initialize_glyph_set();
+  bool initialize_shm();
+  bool use_server_buffer();
+  bool create_shm_image();
+  void destroy_shm_image();
+  void wait_for_puts();
+  static Bool is_put_completion(Display *display, XEvent *event, XPointer arg);
+  void rasterize_glyphs(const terminal_cell *cells, int col_begin,
+                        int col_end, glyph_cache &glyphs,
+                        const XftColor *color, int baseline);
+  bool rasterize_glyph(const cached_glyph &glyph, XGlyphInfo &info,
+                       int &stride);
+  void clear_rects(const XRectangle *rects, int count);
+  void present_area(int x, int y, int width, int height);
+  Picture fill_picture(const XftColor *color);
+  void fill_rect(const XftColor *color, int x, int y, int width, int height);
+  Glyph upload_glyph(cached_glyph &glyph);
+  void forget_glyphs(glyph_cache &cache);
+  const XftColor *resolve_color(uint32_t color, bool background, bool dim);
+  void free_colors();
+  void draw_run(const terminal_frame &frame, int row, int col_begin,
+                int col_end);
+  void draw_glyphs(const terminal_cell *cells, int col_begin, int col_end,
+                   glyph_cache &glyphs, const XftColor *color, int baseline);
+  void composite_glyphs(const terminal_cell *cells, int col_begin,
+                        int col_end, glyph_cache &glyphs,
+                        const XftColor *color, int baseline);
+  cached_glyph &lookup_glyph(glyph_cache &cache, uint32_t codepoint);
+  cached_glyph find_glyph(XftFont *font, uint32_t codepoint);
+
+  static constexpr int margin_x_ = 5;
 };
 
 LinuxTerminalRenderer::LinuxTerminalRenderer(Display *display, Window window)
@@ -45,9 +199,26 @@ LinuxTerminalRenderer::LinuxTerminalRenderer(Display *display, Window window)
       gc_(0) {}
 
 LinuxTerminalRenderer::~LinuxTerminalRenderer() {
+  destroy_shm_image();
+  if (picture_) {
+    XRenderFreePicture(display_, picture_);
+  }
+  if (glyph_set_) {
+    XRenderFreeGlyphSet(display_, glyph_set_);
+  }
   if (xft_draw_) {
     XftDrawDestroy(xft_draw_);
   }
+  if (back_buffer_) {
+    XFreePixmap(display_, back_buffer_);
+  }
+  free_colors();
+  for (XftFont *fallback : fallback_fonts_) {
+    XftFontClose(display_, fallback);
+  }
+  if (bold_font_ && bold_font_ != font_) {
+    XftFontClose(display_, bold_font_);
+  }
   if (font_) {
     XftFontClose(display_, font_);
   }
@@ -65,6 +236,7 @@ bool LinuxTerminalRenderer::initialize() {
 
   width_ = attrs.width;
   height_ = attrs.height;
+  depth_ = attrs.depth;
 
   // Create graphics context
   gc_ = XCreateGC(display_, window_, 0, nullptr);
@@ -75,11 +247,12 @@ bool LinuxTerminalRenderer::initialize() {
   // Set background to black
   XSetForeground(display_, gc_, BlackPixel(display_, DefaultScreen(display_)));
 
-  // Create Xft draw context
-  xft_draw_ = XftDrawCreate(display_, window_,
-                            DefaultVisual(display_, DefaultScreen(display_)),
-                            DefaultColormap(display_, DefaultScreen(display_)));
-  if (!xft_draw_) {
+  // Copies from the back buffer never need GraphicsExpose/NoExpose events
+  XSetGraphicsExposures(display_, gc_, False);
+
+  // Rasterize into shared memory on local servers; otherwise create the
+  // back buffer and an Xft draw context on it
+  if (!initialize_shm() && !use_server_buffer()) {
     return false;
   }
 
@@ -96,6 +269,21 @@ bool LinuxTerminalRenderer::initialize() {
     return false;
   }
 
+  // Bold runs use the bold face when there is one with the same metrics
+  bold_font_ =
+      XftFontOpenName(display_, DefaultScreen(display_), "monospace-12:bold");
+  if (bold_font_ && (bold_font_->height != font_->height ||
+                     bold_font_->ascent != font_->ascent)) {
+    XftFontClose(display_, bold_font_);
+    bold_font_ = nullptr;
+  }
+  if (!bold_font_) {
+    bold_font_ = font_;
+  }
+
+  regular_glyphs_.font = font_;
+  bold_glyphs_.font = bold_font_;
+
   // Calculate character dimensions
   XGlyphInfo glyph_info;
   XftTextExtentsUtf8(display_, font_, (const FcChar8 *)"M", 1, &glyph_info);
@@ -108,58 +296,776 @@ bool LinuxTerminalRenderer::initialize() {
                          DefaultVisual(display_, DefaultScreen(display_)),
                          colormap, "white", &text_color_)) {
     // Fallback to default colors
-    XftColorAllocValue(
-        display_, DefaultVisual(display_, DefaultScreen(display_)), colormap,
-        &(XRenderColor){0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF}, &text_color_);
+    XRenderColor white = {0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF};
+    XftColorAllocValue(display_,
+                       DefaultVisual(display_, DefaultScreen(display_)),
+                       colormap, &white, &text_color_);
   }
 
   if (!XftColorAllocName(display_,
                          DefaultVisual(display_, DefaultScreen(display_)),
                          colormap, "black", &background_color_)) {
-    XftColorAllocValue(
-        display_, DefaultVisual(display_, DefaultScreen(display_)), colormap,
-        &(XRenderColor){0x0000, 0x0000, 0x0000, 0xFFFF}, &background_color_);
+    XRenderColor black = {0x0000, 0x0000, 0x0000, 0xFFFF};
+    XftColorAllocValue(display_,
+                       DefaultVisual(display_, DefaultScreen(display_)),
+                       colormap, &black, &background_color_);
   }
 
   return true;
 }
 
-void LinuxTerminalRenderer::parse_terminal_content(
-    const std::string &content, std::vector<std::string> &lines) {
-  std::istringstream stream(content);
-  std::string line;
-  lines.clear();
+bool LinuxTerminalRenderer::use_server_buffer() {
+  // Glyph ids in the caches refer to the atlas, not to a GlyphSet
+  if (use_shm_) {
+    destroy_shm_image();
+    use_shm_ = false;
+    atlas_.clear();
+    regular_glyphs_.reset();
+    bold_glyphs_.reset();
+  }
+
+  if (!create_back_buffer()) {
+    return false;
+  }
+
+  xft_draw_ = XftDrawCreate(display_, back_buffer_,
+                            DefaultVisual(display_, DefaultScreen(display_)),
+                            DefaultColormap(display_, DefaultScreen(display_)));
+  if (!xft_draw_) {
+    return false;
+  }
+
+  // Without RENDER, or if the window's visual has no picture format, all
+  // drawing goes through Xft
+  initialize_glyph_set();
+  return true;
+}
+
+bool LinuxTerminalRenderer::initialize_glyph_set() {
+  int event_base = 0;
+  int error_base = 0;
+  if (!XRenderQueryExtension(display_, &event_base, &error_base)) {
+    return false;
+  }
+
+  alpha_format_ = XRenderFindStandardFormat(display_, PictStandardA8);
+  window_format_ = XRenderFindVisualFormat(
+      display_, DefaultVisual(display_, DefaultScreen(display_)));
+  if (!alpha_format_ || !window_format_) {
+    return false;
+  }
+
+  glyph_set_ = XRenderCreateGlyphSet(display_, alpha_format_);
+  if (!glyph_set_) {
+    return false;
+  }
+
+  picture_ =
+      XRenderCreatePicture(display_, back_buffer_, window_format_, 0, nullptr);
+  return true;
+}
+
+bool LinuxTerminalRenderer::initialize_shm() {
+  // Shared memory only works with a server on this machine
+  const char *name = DisplayString(display_);
+  bool local = name && (name[0] == ':' || std::strncmp(name, "unix:", 5) == 0);
+  if (!local || !XShmQueryExtension(display_)) {
+    return false;
+  }
+
+  // The rasterizer writes 0x00RRGGBB in native byte order
+  Visual *visual = DefaultVisual(display_, DefaultScreen(display_));
+  uint32_t probe = 1;
+  bool little_endian = *reinterpret_cast<unsigned char *>(&probe) == 1;
+  if (visual->red_mask != 0xFF0000 || visual->green_mask != 0xFF00 ||
+      visual->blue_mask != 0xFF || depth_ < 24 ||
+      (ImageByteOrder(display_) == LSBFirst) != little_endian) {
+    return false;
+  }
+
+  // Puts report completion, so the image is only waited for when the
+  // server is actually behind
+  shm_completion_type_ = XShmGetEventBase(display_) + ShmCompletion;
+
+  use_shm_ = true;
+  if (!create_shm_image()) {
+    use_shm_ = false;
+    return false;
+  }
+  return true;
+}
+
+// Set by x11_error_handler when the server refuses a ShmAttach on one of
+// the library's connections
+static std::atomic<bool> g_shm_attach_failed{false};
+
+bool LinuxTerminalRenderer::create_shm_image() {
+  destroy_shm_image();
+
+  XImage *image = XShmCreateImage(
+      display_, DefaultVisual(display_, DefaultScreen(display_)),
+      static_cast<unsigned>(depth_), ZPixmap, nullptr, &shm_info_,
+      static_cast<unsigned>(std::max(1, width_)),
+      static_cast<unsigned>(std::max(1, height_)));
+  if (!image) {
+    return false;
+  }
+  if (image->bits_per_pixel != 32) {
+    XDestroyImage(image);
+    return false;
+  }
+
+  size_t bytes = static_cast<size_t>(image->bytes_per_line) * image->height;
+  shm_info_.shmid = shmget(IPC_PRIVATE, bytes, IPC_CREAT | 0600);
+  if (shm_info_.shmid < 0) {
+    XDestroyImage(image);
+    return false;
+  }
+
+  shm_info_.shmaddr = static_cast<char *>(shmat(shm_info_.shmid, nullptr, 0));
+  if (shm_info_.shmaddr == reinterpret_cast<char *>(-1)) {
+    shmctl(shm_info_.shmid, IPC_RMID, nullptr);
+    XDestroyImage(image);
+    return false;
+  }
+  shm_info_.readOnly = False;
+  image->data = shm_info_.shmaddr;
+
+  // The server may still refuse the segment, e.g. from another IPC
+  // namespace. x11_error_handler recognizes that error by its request, so
+  // the handler is never swapped while other threads use Xlib. Attaches
+  // only happen on the host thread.
+  g_shm_attach_failed = false;
+  Bool attached = XShmAttach(display_, &shm_info_);
+  XSync(display_, False);
+
+  // Removed once both sides have detached
+  shmctl(shm_info_.shmid, IPC_RMID, nullptr);
+
+  if (!attached || g_shm_attach_failed) {
+    shmdt(shm_info_.shmaddr);
+    image->data = nullptr;
+    XDestroyImage(image);
+    return false;
+  }
+
+  shm_image_ = image;
+  raster_.pixels = reinterpret_cast<uint32_t *>(shm_info_.shmaddr);
+  raster_.width = image->width;
+  raster_.height = image->height;
+  raster_.stride = image->bytes_per_line / 4;
+  back_buffer_valid_ = false;
+  return true;
+}
+
+void LinuxTerminalRenderer::destroy_shm_image() {
+  if (!shm_image_) {
+    return;
+  }
+
+  // The server must be done reading before the memory goes away
+  wait_for_puts();
+  XShmDetach(display_, &shm_info_);
+  XFlush(display_);
+
+  shm_image_->data = nullptr;
+  XDestroyImage(shm_image_);
+  shmdt(shm_info_.shmaddr);
+
+  shm_image_ = nullptr;
+  raster_ = raster_target{};
+}
+
+Bool LinuxTerminalRenderer::is_put_completion(Display *, XEvent *event,
+                                              XPointer arg) {
+  auto renderer = reinterpret_cast<LinuxTerminalRenderer *>(arg);
+  return event->type == renderer->shm_completion_type_ &&
+         reinterpret_cast<XShmCompletionEvent *>(event)->drawable ==
+             renderer->window_;
+}
+
+void LinuxTerminalRenderer::wait_for_puts() {
+  // Completions normally arrive well before the next frame, so taking them
+  // from the queue costs no round trip
+  XEvent event;
+  while (shm_pending_ > 0 &&
+         XCheckIfEvent(display_, &event, is_put_completion,
+                       reinterpret_cast<XPointer>(this))) {
+    --shm_pending_;
+  }
+  if (shm_pending_ == 0) {
+    return;
+  }
+
+  // The server is behind, or a put failed and will never complete, e.g.
+  // because the host destroyed the parent window. After a round trip every
+  // put has been processed and every completion is queued.
+  XSync(display_, False);
+  while (XCheckIfEvent(display_, &event, is_put_completion,
+                       reinterpret_cast<XPointer>(this))) {
+  }
+  shm_pending_ = 0;
+}
+
+bool LinuxTerminalRenderer::create_back_buffer() {
+  if (use_shm_) {
+    return create_shm_image();
+  }
+
+  Pixmap pixmap = XCreatePixmap(display_, window_,
+                                static_cast<unsigned>(std::max(1, width_)),
+                                static_cast<unsigned>(std::max(1, height_)),
+                                static_cast<unsigned>(depth_));
+  if (!pixmap) {
+    return false;
+  }
+
+  if (back_buffer_) {
+    XFreePixmap(display_, back_buffer_);
+  }
+  back_buffer_ = pixmap;
+  back_buffer_valid_ = false;
+
+  if (xft_draw_) {
+    XftDrawChange(xft_draw_, back_buffer_);
+  }
+  if (picture_) {
+    XRenderFreePicture(display_, picture_);
+    picture_ = XRenderCreatePicture(display_, back_buffer_, window_format_, 0,
+                                    nullptr);
+  }
+  return true;
+}
+
+const XftColor *LinuxTerminalRenderer::resolve_color(uint32_t color,
+                                                     bool background,
+                                                     bool dim) {
+  if (color == terminal_color::default_color && !dim) {
+    return background ? &background_color_ : &text_color_;
+  }
+
+  uint32_t rgb =
+      terminal_color::to_rgb(color, background ? 0x000000u : 0xFFFFFFu);
+  if (dim) {
+    rgb = (rgb >> 1) & 0x7F7F7Fu;
+  }
+
+  auto it = colors_.find(rgb);
+  if (it != colors_.end()) {
+    return &it->second;
+  }
+
+  XRenderColor value;
+  value.red = static_cast<unsigned short>(((rgb >> 16) & 0xFF) * 0x101);
+  value.green = static_cast<unsigned short>(((rgb >> 8) & 0xFF) * 0x101);
+  value.blue = static_cast<unsigned short>((rgb & 0xFF) * 0x101);
+  value.alpha = 0xFFFF;
+
+  XftColor allocated;
+  if (!XftColorAllocValue(display_,
+                          DefaultVisual(display_, DefaultScreen(display_)),
+                          DefaultColormap(display_, DefaultScreen(display_)),
+                          &value, &allocated)) {
+    return background ? &background_color_ : &text_color_;
+  }
+  return &colors_.emplace(rgb, allocated).first->second;
+}
+
+void LinuxTerminalRenderer::free_colors() {
+  for (auto &entry : colors_) {
+    XftColorFree(display_, DefaultVisual(display_, DefaultScreen(display_)),
+                 DefaultColormap(display_, DefaultScreen(display_)),
+                 &entry.second);
+  }
+  colors_.clear();
+
+  // Fills are made per color, so they go with the colors
+  for (auto &entry : fills_) {
+    XRenderFreePicture(display_, entry.second);
+  }
+  fills_.clear();
+}
+
+cached_glyph &LinuxTerminalRenderer::lookup_glyph(glyph_cache &cache,
+                                                  uint32_t codepoint) {
+  if (cached_glyph *slot = cache.flat_slot(codepoint)) {
+    if (!slot->font) {
+      *slot = find_glyph(cache.font, codepoint);
+    }
+    return *slot;
+  }
+
+  auto it = cache.others.find(codepoint);
+  if (it != cache.others.end()) {
+    return it->second;
+  }
+
+  return cache.others.emplace(codepoint, find_glyph(cache.font, codepoint))
+      .first->second;
+}
+
+cached_glyph LinuxTerminalRenderer::find_glyph(XftFont *font,
+                                               uint32_t codepoint) {
+  if (XftCharExists(display_, font, codepoint)) {
+    return {font, XftCharIndex(display_, font, codepoint)};
+  }
+
+  for (XftFont *fallback : fallback_fonts_) {
+    if (XftCharExists(display_, fallback, codepoint)) {
+      return {fallback, XftCharIndex(display_, fallback, codepoint)};
+    }
+  }
+
+  // Ask fontconfig for a monospace face that covers the codepoint
+  if (fallback_fonts_.size() < max_fallback_fonts_) {
+    FcPattern *pattern = FcNameParse((const FcChar8 *)"monospace-12");
+    FcCharSet *charset = FcCharSetCreate();
+    FcCharSetAddChar(charset, codepoint);
+    FcPatternAddCharSet(pattern, FC_CHARSET, charset);
+
+    FcResult result;
+    FcPattern *match =
+        XftFontMatch(display_, DefaultScreen(display_), pattern, &result);
+    FcCharSetDestroy(charset);
+    FcPatternDestroy(pattern);
+
+    XftFont *fallback = match ? XftFontOpenPattern(display_, match) : nullptr;
+    if (!fallback && match) {
+      FcPatternDestroy(match);
+    }
+
+    if (fallback && XftCharExists(display_, fallback, codepoint)) {
+      fallback_fonts_.push_back(fallback);
+      return {fallback, XftCharIndex(display_, fallback, codepoint)};
+    }
+    if (fallback) {
+      XftFontClose(display_, fallback);
+    }
+  }
+
+  // Nothing covers it; draw the main face's missing-glyph box
+  return {font, XftCharIndex(display_, font, codepoint)};
+}
+
+void LinuxTerminalRenderer::forget_glyphs(glyph_cache &cache) {
+  // Atlas masks cannot be freed one by one; start the atlas over and look
+  // every glyph up again
+  if (use_shm_) {
+    atlas_.clear();
+    regular_glyphs_.reset();
+    bold_glyphs_.reset();
+    return;
+  }
+
+  // Rare enough that the id list need not be kept around
+  if (glyph_set_) {
+    std::vector<Glyph> uploaded;
+    for (const auto &entry : cache.others) {
+      if (entry.second.uploaded) {
+        uploaded.push_back(entry.second.uploaded);
+      }
+    }
+    if (!uploaded.empty()) {
+      XRenderFreeGlyphs(display_, glyph_set_, uploaded.data(),
+                        static_cast<int>(uploaded.size()));
+    }
+  }
+  cache.others.clear();
+}
+
+bool LinuxTerminalRenderer::rasterize_glyph(const cached_glyph &glyph,
+                                            XGlyphInfo &info, int &stride) {
+  // Every glyph advances by exactly one cell; wide characters overhang into
+  // their trailing cell, which draws a blank
+  info = XGlyphInfo{};
+  info.xOff = static_cast<short>(char_width_);
+  stride = 0;
+
+  glyph_bitmap_.clear();
+  FT_Face face = XftLockFace(glyph.font);
+  if (!face) {
+    return false;
+  }
+
+  bool rendered = FT_Load_Glyph(face, glyph.glyph, FT_LOAD_DEFAULT) == 0 &&
+                  FT_Render_Glyph(face->glyph, FT_RENDER_MODE_NORMAL) == 0;
+  if (rendered) {
+    const FT_Bitmap &bitmap = face->glyph->bitmap;
+    int width = static_cast<int>(bitmap.width);
+    int rows = static_cast<int>(bitmap.rows);
+
+    // A8 glyph rows are padded to four bytes
+    stride = (width + 3) & ~3;
+    glyph_bitmap_.assign(static_cast<size_t>(stride) * rows, 0);
+    for (int y = 0; y < rows; ++y) {
+      const unsigned char *source = bitmap.buffer + y * bitmap.pitch;
+      unsigned char *target = glyph_bitmap_.data() + y * stride;
+      if (bitmap.pixel_mode == FT_PIXEL_MODE_MONO) {
+        for (int x = 0; x < width; ++x) {
+          target[x] = (source[x >> 3] & (0x80 >> (x & 7))) ? 0xFF : 0x00;
+        }
+      } else {
+        std::copy(source, source + width, target);
+      }
+    }
+
+    info.width = static_cast<unsigned short>(width);
+    info.height = static_cast<unsigned short>(rows);
+    info.x = static_cast<short>(-face->glyph->bitmap_left);
+    info.y = static_cast<short>(face->glyph->bitmap_top);
+  }
+
+  XftUnlockFace(glyph.font);
+  return rendered;
+}
+
+Glyph LinuxTerminalRenderer::upload_glyph(cached_glyph &glyph) {
+  XGlyphInfo info;
+  int stride = 0;
+  rasterize_glyph(glyph, info, stride);
+
+  // Glyphs that fail to render are kept as empty masks
+  Glyph id = 0;
+  if (use_shm_) {
+    id = atlas_.add(glyph_bitmap_.data(), info.width, info.height, stride,
+                    -info.x, info.y);
+  } else {
+    id = next_glyph_id_++;
+    XRenderAddGlyphs(display_, glyph_set_, &id, &info, 1,
+                     reinterpret_cast<const char *>(glyph_bitmap_.data()),
+                     static_cast<int>(glyph_bitmap_.size()));
+  }
+  glyph.uploaded = id;
+  return id;
+}
+
+static uint32_t color_rgb(const XftColor *color) {
+  return (uint32_t(color->color.red >> 8) << 16) |
+         (uint32_t(color->color.green >> 8) << 8) |
+         uint32_t(color->color.blue >> 8);
+}
+
+Picture LinuxTerminalRenderer::fill_picture(const XftColor *color) {
+  uint32_t rgb = color_rgb(color);
 
-  while (std::getline(stream, line)) {
-    lines.push_back(line);
+  auto it = fills_.find(rgb);
+  if (it != fills_.end()) {
+    return it->second;
   }
+
+  Picture fill = XRenderCreateSolidFill(display_, &color->color);
+  fills_.emplace(rgb, fill);
+  return fill;
 }
 
-void LinuxTerminalRenderer::render(const std::string &content) {
-  if (!xft_draw_ || !font_) {
+void LinuxTerminalRenderer::fill_rect(const XftColor *color, int x, int y,
+                                      int width, int height) {
+  if (use_shm_) {
+    raster_fill(raster_, {x, y, width, height}, raster_clip_,
+                color_rgb(color));
+  } else if (glyph_set_) {
+    XRenderFillRectangle(display_, PictOpSrc, picture_, &color->color, x, y,
+                         static_cast<unsigned>(width),
+                         static_cast<unsigned>(height));
+  } else {
+    XftDrawRect(xft_draw_, color, x, y, static_cast<unsigned>(width),
+                static_cast<unsigned>(height));
+  }
+}
+
+void LinuxTerminalRenderer::draw_run(const terminal_frame &frame, int row,
+                                     int col_begin, int col_end) {
+  const terminal_cell &style = frame.row(row)[col_begin];
+
+  const XftColor *foreground =
+      resolve_color(style.foreground, false, style.attributes & attr_dim);
+  const XftColor *background = resolve_color(style.background, true, false);
+  if (style.attributes & attr_inverted) {
+    std::swap(foreground, background);
+  }
+
+  int x = margin_x_ + col_begin * char_width_;
+  int y = row * char_height_;
+  int width = (col_end - col_begin) * char_width_;
+  int baseline = y + font_->ascent;
+
+  // The rasterizer clips to the run, as the server clips to the damage
+  raster_clip_ = {x, y, width, char_height_};
+
+  // The damaged area was already cleared to the default background
+  if (background != &background_color_) {
+    fill_rect(background, x, y, width, char_height_);
+  }
+
+  glyph_cache &glyphs = (style.attributes & attr_bold && bold_font_ != font_)
+                            ? bold_glyphs_
+                            : regular_glyphs_;
+  if (use_shm_) {
+    rasterize_glyphs(frame.row(row), col_begin, col_end, glyphs, foreground,
+                     baseline);
+  } else if (glyph_set_) {
+    composite_glyphs(frame.row(row), col_begin, col_end, glyphs, foreground,
+                     baseline);
+  } else {
+    draw_glyphs(frame.row(row), col_begin, col_end, glyphs, foreground,
+                baseline);
+  }
+
+  // Lines are drawn even under blanks, like a terminal does
+  if (style.attributes & (attr_underlined | attr_underlined_double)) {
+    fill_rect(foreground, x, baseline + 1, width, 1);
+    if (style.attributes & attr_underlined_double) {
+      fill_rect(foreground, x, baseline + 3, width, 1);
+    }
+  }
+  if (style.attributes & attr_strikethrough) {
+    fill_rect(foreground, x, baseline - font_->ascent / 3, width, 1);
+  }
+}
+
+void LinuxTerminalRenderer::draw_glyphs(const terminal_cell *cells,
+                                        int col_begin, int col_end,
+                                        glyph_cache &glyphs,
+                                        const XftColor *color, int baseline) {
+  // Place every glyph on its cell, so columns line up whatever the
+  // advances of the faces involved; blanks and the trailing halves of wide
+  // characters draw nothing
+  glyph_specs_.clear();
+  for (int col = col_begin; col < col_end; ++col) {
+    uint32_t codepoint = cells[col].codepoint;
+    if (codepoint == 0 || codepoint == ' ') {
+      continue;
+    }
+
+    const cached_glyph &glyph = lookup_glyph(glyphs, codepoint);
+    XftGlyphFontSpec spec;
+    spec.font = glyph.font;
+    spec.glyph = glyph.glyph;
+    spec.x = static_cast<short>(margin_x_ + col * char_width_);
+    spec.y = static_cast<short>(baseline);
+    glyph_specs_.push_back(spec);
+  }
+
+  if (!glyph_specs_.empty()) {
+    XftDrawGlyphFontSpec(xft_draw_, color, glyph_specs_.data(),
+                         static_cast<int>(glyph_specs_.size()));
+  }
+}
+
+void LinuxTerminalRenderer::composite_glyphs(const terminal_cell *cells,
+                                             int col_begin, int col_end,
+                                             glyph_cache &glyphs,
+                                             const XftColor *color,
+                                             int baseline) {
+  // One glyph per cell, blanks included, so the run is a single element
+  // whose glyphs each advance one cell
+  cached_glyph &blank = lookup_glyph(regular_glyphs_, ' ');
+  Glyph blank_id = blank.uploaded ? blank.uploaded : upload_glyph(blank);
+
+  glyph_ids_.clear();
+  for (int col = col_begin; col < col_end; ++col) {
+    uint32_t codepoint = cells[col].codepoint;
+    if (codepoint == 0 || codepoint == ' ') {
+      glyph_ids_.push_back(static_cast<unsigned int>(blank_id));
+      continue;
+    }
+
+    cached_glyph &glyph = lookup_glyph(glyphs, codepoint);
+    Glyph id = glyph.uploaded ? glyph.uploaded : upload_glyph(glyph);
+    glyph_ids_.push_back(static_cast<unsigned int>(id));
+  }
+
+  int x = margin_x_ + col_begin * char_width_;
+  XGlyphElt32 element;
+  element.glyphset = glyph_set_;
+  element.chars = glyph_ids_.data();
+  element.nchars = static_cast<int>(glyph_ids_.size());
+  element.xOff = x;
+  element.yOff = baseline;
+  XRenderCompositeText32(display_, PictOpOver, fill_picture(color), picture_,
+                         alpha_format_, 0, 0, x, baseline, &element, 1);
+}
+
+void LinuxTerminalRenderer::rasterize_glyphs(const terminal_cell *cells,
+                                             int col_begin, int col_end,
+                                             glyph_cache &glyphs,
+                                             const XftColor *color,
+                                             int baseline) {
+  uint32_t rgb = color_rgb(color);
+  for (int col = col_begin; col < col_end; ++col) {
+    uint32_t codepoint = cells[col].codepoint;
+    if (codepoint == 0 || codepoint == ' ') {
+      continue;
+    }
+
+    cached_glyph &glyph = lookup_glyph(glyphs, codepoint);
+    Glyph id = glyph.uploaded ? glyph.uploaded : upload_glyph(glyph);
+    const glyph_mask &mask = atlas_.mask(static_cast<uint32_t>(id));
+    raster_glyph(raster_, mask, atlas_.coverage(mask),
+                 margin_x_ + col * char_width_, baseline, raster_clip_, rgb);
+  }
+}
+
+void LinuxTerminalRenderer::clear_rects(const XRectangle *rects, int count) {
+  if (use_shm_) {
+    raster_rect everything = {0, 0, raster_.width, raster_.height};
+    uint32_t rgb = color_rgb(&background_color_);
+    for (int i = 0; i < count; ++i) {
+      raster_fill(raster_, {rects[i].x, rects[i].y, rects[i].width,
+                            rects[i].height},
+                  everything, rgb);
+    }
+  } else {
+    XFillRectangles(display_, back_buffer_, gc_,
+                    const_cast<XRectangle *>(rects), count);
+  }
+}
+
+void LinuxTerminalRenderer::present_area(int x, int y, int width,
+                                         int height) {
+  if (use_shm_) {
+    XShmPutImage(display_, window_, gc_, shm_image_, x, y, x, y,
+                 static_cast<unsigned>(width), static_cast<unsigned>(height),
+                 True);
+    ++shm_pending_;
+  } else {
+    XCopyArea(display_, back_buffer_, window_, gc_, x, y,
+              static_cast<unsigned>(width), static_cast<unsigned>(height), x,
+              y);
+  }
+}
+
+void LinuxTerminalRenderer::render(const terminal_frame &frame,
+                                   const std::vector<damage_span> &damage) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!font_ || (use_shm_ ? !shm_image_ : !xft_draw_ || !back_buffer_)) {
     return;
   }
 
-  // Clear window with black background
-  XFillRectangle(display_, window_, gc_, 0, 0, width_, height_);
+  // The last puts may still be reading the image that is about to change
+  if (shm_pending_) {
+    wait_for_puts();
+  }
+
+  // Between frames, so no run holds a pointer into the caches or has
+  // queued a glyph id that is about to be freed
+  if (colors_.size() > max_colors_) {
+    free_colors();
+  }
+  if (regular_glyphs_.others.size() > max_cached_glyphs_) {
+    forget_glyphs(regular_glyphs_);
+  }
+  if (bold_glyphs_.others.size() > max_cached_glyphs_) {
+    forget_glyphs(bold_glyphs_);
+  }
 
-  // Parse content into lines
-  std::vector<std::string> lines;
-  parse_terminal_content(content, lines);
+  // A fresh back buffer has to be painted in full, including the area
+  // around the cell grid
+  const std::vector<damage_span> *spans = &damage;
+  bool repaint_all = !back_buffer_valid_;
+  if (repaint_all) {
+    full_damage_.clear();
+    full_damage(frame, full_damage_);
+    spans = &full_damage_;
 
-  // Render each line
-  int y_offset = char_height_;
-  for (const auto &line : lines) {
-    if (y_offset > height_) {
-      break; // Don't render beyond window bounds
+    XRectangle everything = {0, 0, static_cast<unsigned short>(width_),
+                             static_cast<unsigned short>(height_)};
+    clear_rects(&everything, 1);
+    back_buffer_valid_ = true;
+  }
+
+  if (spans->empty()) {
+    return;
+  }
+
+  // Turn the damaged cell spans into pixel rectangles. Only those are
+  // cleared and repainted; everything else keeps the previous frame.
+  damage_rects_.clear();
+  for (const auto &span : *spans) {
+    XRectangle rect;
+    rect.x = static_cast<short>(margin_x_ + span.col_begin * char_width_);
+    rect.y = static_cast<short>(span.row * char_height_);
+    rect.width = static_cast<unsigned short>(
+        (span.col_end - span.col_begin) * char_width_);
+    rect.height = static_cast<unsigned short>(char_height_);
+    damage_rects_.push_back(rect);
+  }
+
+  if (!damage_rects_.empty()) {
+    clear_rects(damage_rects_.data(), static_cast<int>(damage_rects_.size()));
+
+    // Redraw the damaged cells straight from the cell grid, clipped so
+    // that glyph overhang cannot touch undamaged cells. The rasterizer
+    // clips to each run instead.
+    if (glyph_set_) {
+      XRenderSetPictureClipRectangles(display_, picture_, 0, 0,
+                                      damage_rects_.data(),
+                                      static_cast<int>(damage_rects_.size()));
+    } else if (xft_draw_) {
+      XftDrawSetClipRectangles(xft_draw_, 0, 0, damage_rects_.data(),
+                               static_cast<int>(damage_rects_.size()));
+    }
+
+    for (const auto &span : *spans) {
+      if (span.row >= frame.rows) {
+        continue;
+      }
+
+      int baseline = span.row * char_height_ + font_->ascent;
+      if (baseline > height_) {
+        continue; // Don't render beyond window bounds
+      }
+
+      // Split the span into runs of cells with the same style; finding a
+      // run boundary is one cell comparison, styling costs nothing per
+      // character
+      const terminal_cell *cells = frame.row(span.row);
+      int end = std::min<int>(span.col_end, frame.cols);
+      int begin = span.col_begin;
+      while (begin < end) {
+        const terminal_cell &style = cells[begin];
+        int run_end = begin + 1;
+        while (run_end < end && cells[run_end].foreground == style.foreground &&
+               cells[run_end].background == style.background &&
+               cells[run_end].attributes == style.attributes) {
+          ++run_end;
+        }
+
+        draw_run(frame, span.row, begin, run_end);
+        begin = run_end;
+      }
+    }
+
+    if (glyph_set_) {
+      XRenderPictureAttributes attributes = {};
+      attributes.clip_mask = None;
+      XRenderChangePicture(display_, picture_, CPClipMask, &attributes);
+    } else if (xft_draw_) {
+      XftDrawSetClip(xft_draw_, None);
+    }
+  }
+
+  // Present: copy the whole buffer after a full repaint, otherwise only the
+  // damaged rectangles in a single clipped copy
+  if (repaint_all) {
+    present_area(0, 0, width_, height_);
+  } else {
+    // The left margin is never covered by a span; it only changes with
+    // full repaints, which copy everything
+    int x0 = width_, y0 = height_, x1 = 0, y1 = 0;
+    for (const auto &rect : damage_rects_) {
+      x0 = std::min<int>(x0, rect.x);
+      y0 = std::min<int>(y0, rect.y);
+      x1 = std::max<int>(x1, rect.x + rect.width);
+      y1 = std::max<int>(y1, rect.y + rect.height);
     }
 
-    if (!line.empty()) {
-      XftDrawStringUtf8(xft_draw_, &text_color_, font_, 5,
-                        y_offset, // 5px left margin
-                        (const FcChar8 *)line.c_str(), line.length());
+    if (x1 > x0 && y1 > y0) {
+      XSetClipRectangles(display_, gc_, 0, 0, damage_rects_.data(),
+                         static_cast<int>(damage_rects_.size()), Unsorted);
+      present_area(x0, y0, x1 - x0, y1 - y0);
+      XSetClipMask(display_, gc_, None);
     }
-    y_offset += char_height_;
   }
 
   // Flush to ensure rendering
@@ -167,42 +1073,224 @@ void LinuxTerminalRenderer::render(const std::string &content) {
 }
 
 void LinuxTerminalRenderer::resize(int width, int height) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (width == width_ && height == height_) {
+    return;
+  }
+
   width_ = width;
   height_ = height;
+
+  // The old contents do not match the new size; the next frame repaints
+  // the new buffer in full. If shared memory runs out, draw on the server.
+  if (!create_back_buffer() && use_shm_) {
+    use_server_buffer();
+  }
 }
 
-// Event handling for X11 windows
-static int x11_error_handler(Display *display, XErrorEvent *error) {
-  // Log error but don't crash
-  char error_text[256];
-  XGetErrorText(display, error->error_code, error_text, sizeof(error_text));
-  // In a real implementation, you might want to log this
-  return 0;
+void LinuxTerminalRenderer::expose(int x, int y, int width, int height) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  // Before the first frame there is nothing to show but the window's
+  // background, which the server already painted
+  if (!back_buffer_valid_ || (use_shm_ ? !shm_image_ : !back_buffer_)) {
+    return;
+  }
+
+  // Puts only read the image, so this one need not wait for earlier ones
+  x = std::max(0, x);
+  y = std::max(0, y);
+  width = std::min(width, width_ - x);
+  height = std::min(height, height_ - y);
+  if (width > 0 && height > 0) {
+    present_area(x, y, width, height);
+    XFlush(display_);
+  }
 }
 
 // Platform-specific storage for Linux
-static std::unordered_map<void *, std::unique_ptr<LinuxTerminalRenderer>>
+static std::unordered_map<void *, std::shared_ptr<LinuxTerminalRenderer>>
     g_renderers;
+static std::mutex g_renderers_mutex;
 static Display *g_display = nullptr;
+static Display *g_event_display = nullptr;
+
+// The handler is process-wide. It is installed once while the connections
+// are open, handles errors on the library's own connections and passes
+// every other error, e.g. the host's, to the handler it replaced.
+static XErrorHandler g_previous_error_handler = nullptr;
+static int g_shm_opcode = 0;
+
+// X_ShmAttach; the protocol header needs the server-side types
+static constexpr int shm_attach_minor = 1;
+
+static int x11_error_handler(Display *display, XErrorEvent *error) {
+  if (display != g_display && display != g_event_display) {
+    return g_previous_error_handler ? g_previous_error_handler(display, error)
+                                    : 0;
+  }
+
+  // A refused segment is checked right after the attach; any other error
+  // on our connections, e.g. BadWindow for a window the host destroyed
+  // under us, is not fatal
+  if (g_shm_opcode && error->request_code == g_shm_opcode &&
+      error->minor_code == shm_attach_minor) {
+    g_shm_attach_failed = true;
+  }
+  return 0;
+}
+
+// Windows are created on the host thread, presented on the render thread
+// and repaired on the event thread; renderers lock themselves
+static std::shared_ptr<LinuxTerminalRenderer>
+find_renderer(void *platform_handle) {
+  std::lock_guard<std::mutex> lock(g_renderers_mutex);
+  auto it = g_renderers.find(platform_handle);
+  return it != g_renderers.end() ? it->second : nullptr;
+}
+
+// Repaints windows uncovered or mapped while their editor is idle, without
+// waiting for a new frame. The thread has a display connection of its own
+// that only selects exposures on the editor windows, so it can block until
+// that connection or the wake pipe has something to read; an idle session
+// never wakes it.
+static std::thread g_event_thread;
+static std::atomic<bool> g_event_stop{false};
+static int g_event_pipe[2] = {-1, -1};
+
+// Windows created since the event thread last looked, to select exposures
+// on; Xlib calls on g_event_display stay on the event thread
+static std::mutex g_watch_mutex;
+static std::vector<Window> g_watch_windows;
+
+static void wake_event_thread() {
+  char wake = 0;
+  ssize_t written = write(g_event_pipe[1], &wake, 1);
+  (void)written;
+}
+
+static void watch_window(Window window) {
+  if (!g_event_thread.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(g_watch_mutex);
+    g_watch_windows.push_back(window);
+  }
+  wake_event_thread();
+}
+
+static void event_loop() {
+  pollfd fds[2] = {{ConnectionNumber(g_event_display), POLLIN, 0},
+                   {g_event_pipe[0], POLLIN, 0}};
+  std::vector<Window> windows;
+
+  while (true) {
+    // Only this thread uses the connection, so once XPending has read
+    // what the socket holds and the queue is empty, poll sees the rest
+    while (XPending(g_event_display) > 0) {
+      XEvent event;
+      XNextEvent(g_event_display, &event);
+      if (event.type != Expose) {
+        continue;
+      }
+
+      void *handle = reinterpret_cast<void *>(event.xexpose.window);
+      if (auto renderer = find_renderer(handle)) {
+        renderer->expose(event.xexpose.x, event.xexpose.y,
+                         event.xexpose.width, event.xexpose.height);
+      }
+    }
+
+    if (poll(fds, 2, -1) <= 0 || !(fds[1].revents & POLLIN)) {
+      continue;
+    }
+
+    char wakes[64];
+    ssize_t drained = read(g_event_pipe[0], wakes, sizeof(wakes));
+    (void)drained;
+    if (g_event_stop) {
+      return;
+    }
+
+    // A window destroyed in the meantime only costs a BadWindow error
+    {
+      std::lock_guard<std::mutex> lock(g_watch_mutex);
+      windows.swap(g_watch_windows);
+    }
+    for (Window window : windows) {
+      XSelectInput(g_event_display, window, ExposureMask);
+    }
+    windows.clear();
+    XFlush(g_event_display);
+  }
+}
 
 bool embedded_terminal::platform_initialize() {
   if (!g_display) {
+    // The display connection is shared by the host thread (window
+    // management), the render thread (presentation) and the event thread.
+    // libX11 1.8 and newer, which the build requires, are thread-safe from
+    // the start; calling XInitThreads() here, after the host has already
+    // used Xlib, would be undefined on older versions.
     g_display = XOpenDisplay(nullptr);
     if (!g_display) {
       return false;
     }
 
-    // Set up error handler
-    XSetErrorHandler(x11_error_handler);
+    // Errors on our connections are handled, not fatal
+    int event_base = 0;
+    int error_base = 0;
+    if (!XQueryExtension(g_display, "MIT-SHM", &g_shm_opcode, &event_base,
+                         &error_base)) {
+      g_shm_opcode = 0;
+    }
+    g_previous_error_handler = XSetErrorHandler(x11_error_handler);
+
+    // Without a second connection idle windows are only repaired by
+    // their next frame
+    g_event_display = XOpenDisplay(nullptr);
+    if (g_event_display && pipe(g_event_pipe) == 0) {
+      g_event_stop = false;
+      g_event_thread = std::thread(event_loop);
+    }
   }
   return true;
 }
 
 void embedded_terminal::platform_shutdown() {
-  g_renderers.clear();
+  if (g_event_thread.joinable()) {
+    g_event_stop = true;
+    wake_event_thread();
+    g_event_thread.join();
+  }
+  for (int &fd : g_event_pipe) {
+    if (fd >= 0) {
+      close(fd);
+      fd = -1;
+    }
+  }
+  if (g_event_display) {
+    XCloseDisplay(g_event_display);
+    g_event_display = nullptr;
+  }
+  g_watch_windows.clear();
+
+  {
+    std::lock_guard<std::mutex> lock(g_renderers_mutex);
+    g_renderers.clear();
+  }
   if (g_display) {
     XCloseDisplay(g_display);
     g_display = nullptr;
+
+    // Hand errors back to the previous handler once nothing can fail on
+    // our connections, unless another one was installed on top of ours
+    XErrorHandler current = XSetErrorHandler(g_previous_error_handler);
+    if (current != x11_error_handler) {
+      XSetErrorHandler(current);
+    }
+    g_previous_error_handler = nullptr;
   }
 }
 
@@ -228,31 +1316,34 @@ bool embedded_terminal::platform_create_window(editor_window &window,
     return false;
   }
 
-  // Select events
-  XSelectInput(g_display, child_window, ExposureMask | StructureNotifyMask);
-
   // Map window
   XMapWindow(g_display, child_window);
 
   // Create renderer
   auto renderer =
-      std::make_unique<LinuxTerminalRenderer>(g_display, child_window);
+      std::make_shared<LinuxTerminalRenderer>(g_display, child_window);
   if (!renderer->initialize()) {
     XDestroyWindow(g_display, child_window);
     return false;
   }
 
   window.platform_handle = reinterpret_cast<void *>(child_window);
-  g_renderers[window.platform_handle] = std::move(renderer);
+  {
+    std::lock_guard<std::mutex> lock(g_renderers_mutex);
+    g_renderers[window.platform_handle] = std::move(renderer);
+  }
 
   XFlush(g_display);
+
+  // Only exposures are handled, on the event thread's connection; size
+  // changes come from the host
+  watch_window(child_window);
   return true;
 }
 
 void embedded_terminal::platform_update_window(editor_window &window) {
-  auto it = g_renderers.find(window.platform_handle);
-  if (it != g_renderers.end()) {
-    it->second->render(window.content);
+  if (auto renderer = find_renderer(window.platform_handle)) {
+    renderer->render(*window.frame, *window.damage);
   }
 }
 
@@ -262,9 +1353,8 @@ void embedded_terminal::platform_resize_window(editor_window &window, int width,
   if (x_window && g_display) {
     XResizeWindow(g_display, x_window, width, height);
 
-    auto it = g_renderers.find(window.platform_handle);
-    if (it != g_renderers.end()) {
-      it->second->resize(width, height);
+    if (auto renderer = find_renderer(window.platform_handle)) {
+      renderer->resize(width, height);
     }
 
     XFlush(g_display);
@@ -287,7 +1377,10 @@ void embedded_terminal::platform_show_window(editor_window &window,
 void embedded_terminal::platform_destroy_window(editor_window &window) {
   Window x_window = reinterpret_cast<Window>(window.platform_handle);
   if (x_window && g_display) {
-    g_renderers.erase(window.platform_handle);
+    {
+      std::lock_guard<std::mutex> lock(g_renderers_mutex);
+      g_renderers.erase(window.platform_handle);
+    }
     XDestroyWindow(g_display, x_window);
     XFlush(g_display);
     window.platform_handle = nullptr;
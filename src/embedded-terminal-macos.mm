@@ -7,6 +7,7 @@
 #import <Metal/Metal.h>
 #import <MetalKit/MetalKit.h>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 
 // Custom NSView for rendering terminal content using simple text rendering
@@ -76,31 +77,8 @@
     }
     else
     {
-        NSLog(@"Rendering actual terminal content, original length: %lu",
+        NSLog(@"Rendering actual terminal content, length: %lu",
               (unsigned long)[textToRender length]);
-        // Strip ANSI escape sequences for now (like [1m, [22m)
-        NSError *error = nil;
-        NSRegularExpression *ansiRegex =
-            [NSRegularExpression regularExpressionWithPattern:@"\\[[0-9;]*m"
-                                                      options:0
-                                                        error:&error];
-        if (!error)
-        {
-            NSString *strippedText =
-                [ansiRegex stringByReplacingMatchesInString:textToRender
-                                                    options:0
-                                                      range:NSMakeRange(0, [textToRender length])
-                                               withTemplate:@""];
-            NSLog(@"After ANSI stripping, length: %lu", (unsigned long)[strippedText length]);
-            textToRender = strippedText;
-        }
-
-        // Ensure we have content after stripping
-        if ([textToRender length] == 0)
-        {
-            NSLog(@"Content became empty after ANSI stripping, using fallback");
-            textToRender = @"FTXUI Content (ANSI stripped to empty)";
-        }
     }
 
     // Clear the background first
@@ -131,6 +109,16 @@
 
 // Platform-specific storage for macOS windows
 static std::unordered_map<void *, FTXUITerminalView *> g_platform_views;
+static std::mutex g_platform_views_mutex;
+
+// Views are created on the host thread and presented on the render thread;
+// each view is only used under its window's lock
+static FTXUITerminalView *find_view(void *platform_handle)
+{
+    std::lock_guard<std::mutex> lock(g_platform_views_mutex);
+    auto it = g_platform_views.find(platform_handle);
+    return it != g_platform_views.end() ? it->second : nil;
+}
 
 namespace ftxui_clap_support
 {
@@ -140,7 +128,11 @@ bool embedded_terminal::platform_initialize()
     return true; // macOS-specific initialization if needed
 }
 
-void embedded_terminal::platform_shutdown() { g_platform_views.clear(); }
+void embedded_terminal::platform_shutdown()
+{
+    std::lock_guard<std::mutex> lock(g_platform_views_mutex);
+    g_platform_views.clear();
+}
 
 bool embedded_terminal::platform_create_window(editor_window &window, void *parent_handle, int x,
                                                int y, int width, int height)
@@ -169,7 +161,10 @@ bool embedded_terminal::platform_create_window(editor_window &window, void *pare
         [parentView addSubview:terminalView];
 
         window.platform_handle = (__bridge void *)terminalView;
-        g_platform_views[window.platform_handle] = terminalView;
+        {
+            std::lock_guard<std::mutex> lock(g_platform_views_mutex);
+            g_platform_views[window.platform_handle] = terminalView;
+        }
 
         NSLog(@"Terminal view created and added to parent view");
         return true;
@@ -180,11 +175,13 @@ void embedded_terminal::platform_update_window(editor_window &window)
 {
     @autoreleasepool
     {
-        auto it = g_platform_views.find(window.platform_handle);
-        if (it != g_platform_views.end())
+        FTXUITerminalView *view = find_view(window.platform_handle);
+        if (view)
         {
-            FTXUITerminalView *view = it->second;
-            NSString *content = [NSString stringWithUTF8String:window.content.c_str()];
+            // Frames arrive as cell grids; the view still draws plain text
+            std::string text;
+            frame_to_text(*window.frame, text);
+            NSString *content = [NSString stringWithUTF8String:text.c_str()];
 
             // Debug logging
             NSLog(@"Updating window content: %@ (length: %lu)", content, [content length]);
@@ -200,10 +197,9 @@ void embedded_terminal::platform_resize_window(editor_window &window, int width,
 {
     @autoreleasepool
     {
-        auto it = g_platform_views.find(window.platform_handle);
-        if (it != g_platform_views.end())
+        FTXUITerminalView *view = find_view(window.platform_handle);
+        if (view)
         {
-            FTXUITerminalView *view = it->second;
             NSRect newFrame = view.frame;
             newFrame.size.width = width;
             newFrame.size.height = height;
@@ -216,10 +212,9 @@ void embedded_terminal::platform_show_window(editor_window &window, bool visible
 {
     @autoreleasepool
     {
-        auto it = g_platform_views.find(window.platform_handle);
-        if (it != g_platform_views.end())
+        FTXUITerminalView *view = find_view(window.platform_handle);
+        if (view)
         {
-            FTXUITerminalView *view = it->second;
             [view setHidden:!visible];
         }
     }
@@ -229,12 +224,13 @@ void embedded_terminal::platform_destroy_window(editor_window &window)
 {
     @autoreleasepool
     {
-        auto it = g_platform_views.find(window.platform_handle);
-        if (it != g_platform_views.end())
+        FTXUITerminalView *view = find_view(window.platform_handle);
+        if (view)
         {
-            FTXUITerminalView *view = it->second;
             [view removeFromSuperview];
-            g_platform_views.erase(it);
+
+            std::lock_guard<std::mutex> lock(g_platform_views_mutex);
+            g_platform_views.erase(window.platform_handle);
         }
         window.platform_handle = nullptr;
     }
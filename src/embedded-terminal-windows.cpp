@@ -6,6 +6,7 @@
 #include <d3d11.h>
 #include <dwrite.h>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <windows.h>
 #include <wrl/client.h>
@@ -21,7 +22,7 @@ public:
   ~WindowsTerminalRenderer();
 
   bool initialize();
-  void render(const std::string &content);
+  void render(const terminal_frame &frame);
   void resize(int width, int height);
 
 private:
@@ -35,6 +36,9 @@ private:
 
   float char_width_ = 8.0f;
   float char_height_ = 16.0f;
+
+  // Scratch storage reused across frames
+  std::string content_;
 };
 
 WindowsTerminalRenderer::WindowsTerminalRenderer(HWND hwnd) : hwnd_(hwnd) {}
@@ -108,10 +112,13 @@ bool WindowsTerminalRenderer::initialize() {
   return true;
 }
 
-void WindowsTerminalRenderer::render(const std::string &content) {
+void WindowsTerminalRenderer::render(const terminal_frame &frame) {
   if (!render_target_)
     return;
 
+  frame_to_text(frame, content_);
+  const std::string &content = content_;
+
   render_target_->BeginDraw();
 
   // Clear background
@@ -183,8 +190,17 @@ LRESULT CALLBACK TerminalWindowProc(HWND hwnd, UINT msg, WPARAM wParam,
 // Platform-specific storage for Windows
 static std::unordered_map<void *, std::unique_ptr<WindowsTerminalRenderer>>
     g_renderers;
+static std::mutex g_renderers_mutex;
 static bool g_class_registered = false;
 
+// Windows are created on the host thread and presented on the render
+// thread; each renderer is only used under its window's lock
+static WindowsTerminalRenderer *find_renderer(void *platform_handle) {
+  std::lock_guard<std::mutex> lock(g_renderers_mutex);
+  auto it = g_renderers.find(platform_handle);
+  return it != g_renderers.end() ? it->second.get() : nullptr;
+}
+
 bool embedded_terminal::platform_initialize() {
   if (!g_class_registered) {
     WNDCLASSEX wc = {};
@@ -205,7 +221,10 @@ bool embedded_terminal::platform_initialize() {
 }
 
 void embedded_terminal::platform_shutdown() {
-  g_renderers.clear();
+  {
+    std::lock_guard<std::mutex> lock(g_renderers_mutex);
+    g_renderers.clear();
+  }
   if (g_class_registered) {
     UnregisterClass(L"FTXUITerminalWindow", GetModuleHandle(nullptr));
     g_class_registered = false;
@@ -238,15 +257,17 @@ bool embedded_terminal::platform_create_window(editor_window &window,
                    reinterpret_cast<LONG_PTR>(renderer.get()));
 
   window.platform_handle = child_hwnd;
-  g_renderers[window.platform_handle] = std::move(renderer);
+  {
+    std::lock_guard<std::mutex> lock(g_renderers_mutex);
+    g_renderers[window.platform_handle] = std::move(renderer);
+  }
 
   return true;
 }
 
 void embedded_terminal::platform_update_window(editor_window &window) {
-  auto it = g_renderers.find(window.platform_handle);
-  if (it != g_renderers.end()) {
-    it->second->render(window.content);
+  if (auto renderer = find_renderer(window.platform_handle)) {
+    renderer->render(*window.frame);
     InvalidateRect(static_cast<HWND>(window.platform_handle), nullptr, FALSE);
   }
 }
@@ -257,9 +278,8 @@ void embedded_terminal::platform_resize_window(editor_window &window, int width,
   if (hwnd) {
     SetWindowPos(hwnd, nullptr, 0, 0, width, height, SWP_NOMOVE | SWP_NOZORDER);
 
-    auto it = g_renderers.find(window.platform_handle);
-    if (it != g_renderers.end()) {
-      it->second->resize(width, height);
+    if (auto renderer = find_renderer(window.platform_handle)) {
+      renderer->resize(width, height);
     }
   }
 }
@@ -275,7 +295,10 @@ void embedded_terminal::platform_show_window(editor_window &window,
 void embedded_terminal::platform_destroy_window(editor_window &window) {
   HWND hwnd = static_cast<HWND>(window.platform_handle);
   if (hwnd) {
-    g_renderers.erase(window.platform_handle);
+    {
+      std::lock_guard<std::mutex> lock(g_renderers_mutex);
+      g_renderers.erase(window.platform_handle);
+    }
     DestroyWindow(hwnd);
     window.platform_handle = nullptr;
   }
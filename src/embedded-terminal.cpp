@@ -1,6 +1,6 @@
 #include "embedded-terminal.h"
 #include <algorithm>
-#include <sstream>
+#include <utility>
 
 namespace ftxui_clap_support
 {
@@ -17,47 +17,87 @@ bool embedded_terminal::initialize() { return platform_initialize(); }
 
 void embedded_terminal::shutdown()
 {
-    std::lock_guard<std::mutex> lock(editors_mutex_);
+    std::unordered_map<std::string, std::shared_ptr<editor_window>> editors;
+    {
+        std::lock_guard<std::mutex> lock(editors_mutex_);
+        editors.swap(editors_);
+    }
 
-    for (auto &[id, window] : editors_)
+    for (auto &[id, window] : editors)
     {
+        std::lock_guard<std::mutex> window_lock(window->mutex);
         platform_destroy_window(*window);
     }
-    editors_.clear();
 
     platform_shutdown();
 }
 
-void embedded_terminal::update_content(const std::string &editor_id, const std::string &content)
+std::shared_ptr<embedded_terminal::editor_window>
+embedded_terminal::find_window(const std::string &editor_id)
 {
     std::lock_guard<std::mutex> lock(editors_mutex_);
 
     auto it = editors_.find(editor_id);
-    if (it != editors_.end())
+    return it != editors_.end() ? it->second : nullptr;
+}
+
+void embedded_terminal::present(const std::string &editor_id)
+{
+    auto window = find_window(editor_id);
+    if (!window)
+        return;
+
+    std::lock_guard<std::mutex> window_lock(window->mutex);
+    if (!window->platform_handle)
+        return;
+
+    const mailbox_frame *published = window->mailbox->take();
+    if (!published)
+        return;
+
+    window->frame = &published->frame;
+    window->damage = &published->damage;
+
+    // Each frame's damage is relative to its predecessor, so a skipped
+    // frame means the window may be missing changes outside this damage
+    if (published->sequence != window->presented_sequence + 1)
     {
-        it->second->content = content;
-        platform_update_window(*it->second);
+        window->full_damage.clear();
+        full_damage(published->frame, window->full_damage);
+        window->damage = &window->full_damage;
     }
+    window->presented_sequence = published->sequence;
+
+    platform_update_window(*window);
+
+    window->frame = nullptr;
+    window->damage = nullptr;
 }
 
 void embedded_terminal::remove_editor(const std::string &editor_id)
 {
-    std::lock_guard<std::mutex> lock(editors_mutex_);
-
-    auto it = editors_.find(editor_id);
-    if (it != editors_.end())
+    std::shared_ptr<editor_window> window;
     {
-        platform_destroy_window(*it->second);
+        std::lock_guard<std::mutex> lock(editors_mutex_);
+
+        auto it = editors_.find(editor_id);
+        if (it == editors_.end())
+            return;
+
+        window = std::move(it->second);
         editors_.erase(it);
     }
+
+    std::lock_guard<std::mutex> window_lock(window->mutex);
+    platform_destroy_window(*window);
 }
 
 bool embedded_terminal::create_window(const std::string &editor_id, void *parent_handle, int x,
-                                      int y, int width, int height)
+                                      int y, int width, int height,
+                                      std::shared_ptr<frame_mailbox> mailbox)
 {
-    std::lock_guard<std::mutex> lock(editors_mutex_);
-
-    auto window = std::make_unique<editor_window>();
+    auto window = std::make_shared<editor_window>();
+    window->mailbox = std::move(mailbox);
     window->width = width;
     window->height = height;
 
@@ -66,32 +106,42 @@ bool embedded_terminal::create_window(const std::string &editor_id, void *parent
         return false;
     }
 
-    editors_[editor_id] = std::move(window);
+    std::shared_ptr<editor_window> replaced;
+    {
+        std::lock_guard<std::mutex> lock(editors_mutex_);
+        replaced = std::exchange(editors_[editor_id], window);
+    }
+
+    // Reparenting replaces the previous window
+    if (replaced)
+    {
+        std::lock_guard<std::mutex> window_lock(replaced->mutex);
+        platform_destroy_window(*replaced);
+    }
+
     return true;
 }
 
 void embedded_terminal::resize_window(const std::string &editor_id, int width, int height)
 {
-    std::lock_guard<std::mutex> lock(editors_mutex_);
-
-    auto it = editors_.find(editor_id);
-    if (it != editors_.end())
+    auto window = find_window(editor_id);
+    if (window)
     {
-        it->second->width = width;
-        it->second->height = height;
-        platform_resize_window(*it->second, width, height);
+        std::lock_guard<std::mutex> window_lock(window->mutex);
+        window->width = width;
+        window->height = height;
+        platform_resize_window(*window, width, height);
     }
 }
 
 void embedded_terminal::show_window(const std::string &editor_id, bool visible)
 {
-    std::lock_guard<std::mutex> lock(editors_mutex_);
-
-    auto it = editors_.find(editor_id);
-    if (it != editors_.end())
+    auto window = find_window(editor_id);
+    if (window)
     {
-        it->second->visible = visible;
-        platform_show_window(*it->second, visible);
+        std::lock_guard<std::mutex> window_lock(window->mutex);
+        window->visible = visible;
+        platform_show_window(*window, visible);
     }
 }
 
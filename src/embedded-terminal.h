@@ -1,9 +1,13 @@
 #pragma once
 
+#include "frame-mailbox.h"
+#include "terminal-frame.h"
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace ftxui_clap_support {
 
@@ -23,15 +27,19 @@ public:
   // Shutdown and cleanup
   void shutdown();
 
-  // Update content for a specific editor
-  void update_content(const std::string &editor_id, const std::string &content);
+  // Present the newest frame published to the editor's mailbox, if any.
+  // Frames published in between are dropped; damage that was lost with
+  // them is recovered by repainting the whole window.
+  void present(const std::string &editor_id);
 
   // Remove content for an editor
   void remove_editor(const std::string &editor_id);
 
-  // Platform-specific window creation
+  // Platform-specific window creation. The window presents frames that the
+  // render stage publishes to mailbox.
   bool create_window(const std::string &editor_id, void *parent_handle, int x,
-                     int y, int width, int height);
+                     int y, int width, int height,
+                     std::shared_ptr<frame_mailbox> mailbox);
 
   // Update window size
   void resize_window(const std::string &editor_id, int width, int height);
@@ -41,16 +49,30 @@ public:
 
 private:
   struct editor_window {
-    std::string content;
+    // Serializes platform calls on this window; editors_mutex_ is never
+    // held while a platform call runs
+    std::mutex mutex;
+
+    std::shared_ptr<frame_mailbox> mailbox;
+    uint64_t presented_sequence = 0;
+    std::vector<damage_span> full_damage;
+
+    // Frame being presented, valid during platform_update_window()
+    const terminal_frame *frame = nullptr;
+    const std::vector<damage_span> *damage = nullptr;
+
     void *platform_handle = nullptr;
     int width = 0;
     int height = 0;
     bool visible = false;
   };
 
-  std::unordered_map<std::string, std::unique_ptr<editor_window>> editors_;
+  // Only guards the map itself
+  std::unordered_map<std::string, std::shared_ptr<editor_window>> editors_;
   std::mutex editors_mutex_;
 
+  std::shared_ptr<editor_window> find_window(const std::string &editor_id);
+
   // Platform-specific initialization
   bool platform_initialize();
   void platform_shutdown();
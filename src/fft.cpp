@@ -0,0 +1,124 @@
+#include "fft.h"
+#include <cmath>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FTXUI_CLAP_SIMD_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define FTXUI_CLAP_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace ftxui_clap_support
+{
+
+fft::fft(size_t size) : size_(size), bit_reverse_(size)
+{
+    size_t bits = 0;
+    while ((size_t(1) << bits) < size_)
+    {
+        ++bits;
+    }
+
+    for (size_t i = 0; i < size_; ++i)
+    {
+        size_t reversed = 0;
+        for (size_t b = 0; b < bits; ++b)
+        {
+            reversed |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        bit_reverse_[i] = reversed;
+    }
+
+    const double pi = 3.14159265358979323846;
+    twiddle_re_.reserve(size_);
+    twiddle_im_.reserve(size_);
+    for (size_t m = 2; m <= size_; m *= 2)
+    {
+        for (size_t k = 0; k < m / 2; ++k)
+        {
+            double angle = -2.0 * pi * static_cast<double>(k) / static_cast<double>(m);
+            twiddle_re_.push_back(static_cast<float>(std::cos(angle)));
+            twiddle_im_.push_back(static_cast<float>(std::sin(angle)));
+        }
+    }
+}
+
+void fft::forward(float *re, float *im) const
+{
+    for (size_t i = 0; i < size_; ++i)
+    {
+        size_t j = bit_reverse_[i];
+        if (i < j)
+        {
+            std::swap(re[i], re[j]);
+            std::swap(im[i], im[j]);
+        }
+    }
+
+    const float *stage_re = twiddle_re_.data();
+    const float *stage_im = twiddle_im_.data();
+    for (size_t m = 2; m <= size_; m *= 2)
+    {
+        size_t half = m / 2;
+        for (size_t start = 0; start < size_; start += m)
+        {
+            float *a_re = re + start;
+            float *a_im = im + start;
+            float *b_re = a_re + half;
+            float *b_im = a_im + half;
+
+            size_t k = 0;
+#if defined(FTXUI_CLAP_SIMD_SSE2)
+            for (; k + 4 <= half; k += 4)
+            {
+                __m128 w_re = _mm_loadu_ps(stage_re + k);
+                __m128 w_im = _mm_loadu_ps(stage_im + k);
+                __m128 x_re = _mm_loadu_ps(b_re + k);
+                __m128 x_im = _mm_loadu_ps(b_im + k);
+                __m128 t_re = _mm_sub_ps(_mm_mul_ps(x_re, w_re), _mm_mul_ps(x_im, w_im));
+                __m128 t_im = _mm_add_ps(_mm_mul_ps(x_re, w_im), _mm_mul_ps(x_im, w_re));
+                __m128 u_re = _mm_loadu_ps(a_re + k);
+                __m128 u_im = _mm_loadu_ps(a_im + k);
+                _mm_storeu_ps(a_re + k, _mm_add_ps(u_re, t_re));
+                _mm_storeu_ps(a_im + k, _mm_add_ps(u_im, t_im));
+                _mm_storeu_ps(b_re + k, _mm_sub_ps(u_re, t_re));
+                _mm_storeu_ps(b_im + k, _mm_sub_ps(u_im, t_im));
+            }
+#elif defined(FTXUI_CLAP_SIMD_NEON)
+            for (; k + 4 <= half; k += 4)
+            {
+                float32x4_t w_re = vld1q_f32(stage_re + k);
+                float32x4_t w_im = vld1q_f32(stage_im + k);
+                float32x4_t x_re = vld1q_f32(b_re + k);
+                float32x4_t x_im = vld1q_f32(b_im + k);
+                float32x4_t t_re = vmlsq_f32(vmulq_f32(x_re, w_re), x_im, w_im);
+                float32x4_t t_im = vmlaq_f32(vmulq_f32(x_re, w_im), x_im, w_re);
+                float32x4_t u_re = vld1q_f32(a_re + k);
+                float32x4_t u_im = vld1q_f32(a_im + k);
+                vst1q_f32(a_re + k, vaddq_f32(u_re, t_re));
+                vst1q_f32(a_im + k, vaddq_f32(u_im, t_im));
+                vst1q_f32(b_re + k, vsubq_f32(u_re, t_re));
+                vst1q_f32(b_im + k, vsubq_f32(u_im, t_im));
+            }
+#endif
+            for (; k < half; ++k)
+            {
+                float t_re = b_re[k] * stage_re[k] - b_im[k] * stage_im[k];
+                float t_im = b_re[k] * stage_im[k] + b_im[k] * stage_re[k];
+                float u_re = a_re[k];
+                float u_im = a_im[k];
+                a_re[k] = u_re + t_re;
+                a_im[k] = u_im + t_im;
+                b_re[k] = u_re - t_re;
+                b_im[k] = u_im - t_im;
+            }
+        }
+
+        stage_re += half;
+        stage_im += half;
+    }
+}
+
+} // namespace ftxui_clap_support
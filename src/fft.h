@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace ftxui_clap_support {
+
+/**
+ * In-place radix-2 complex FFT on split real/imaginary arrays.
+ *
+ * Twiddle factors are stored per stage so that the butterflies of a stage
+ * read them contiguously; stages with at least four butterflies per group
+ * run four at a time with SSE2 or NEON.
+ */
+class fft {
+public:
+  // size must be a power of two, at least 2
+  explicit fft(size_t size);
+
+  size_t size() const { return size_; }
+
+  // Forward transform of size() values in re and im
+  void forward(float *re, float *im) const;
+
+private:
+  size_t size_;
+  std::vector<size_t> bit_reverse_;
+
+  // For each stage of group size m, m/2 twiddles cos/sin(-2 pi k / m),
+  // stored back to back starting with m = 2
+  std::vector<float> twiddle_re_;
+  std::vector<float> twiddle_im_;
+};
+
+} // namespace ftxui_clap_support
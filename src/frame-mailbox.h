@@ -0,0 +1,24 @@
+#pragma once
+
+#include "ftxui-clap-support/ftxui-clap-triple-buffer.h"
+#include "terminal-frame.h"
+#include <cstdint>
+#include <vector>
+
+namespace ftxui_clap_support {
+
+// A published frame together with the damage relative to the frame that
+// was published before it
+struct mailbox_frame {
+  terminal_frame frame;
+  std::vector<damage_span> damage;
+  uint64_t sequence = 0;
+};
+
+// Latest-wins handoff from the render stage to the presenter. The render
+// stage diffs against lastPublished(); a frame published again before the
+// presenter took it is dropped, which the presenter notices through a gap
+// in the sequence numbers.
+using frame_mailbox = ftxui_clap_triple_buffer<mailbox_frame>;
+
+} // namespace ftxui_clap_support
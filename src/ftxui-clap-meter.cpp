@@ -0,0 +1,137 @@
+#include "ftxui-clap-support/ftxui-clap-meter.h"
+#include <algorithm>
+#include <ftxui/dom/node.hpp>
+#include <ftxui/screen/screen.hpp>
+
+namespace ftxui_clap_support
+{
+
+// Partial blocks from one to eight eighths of a cell
+static const char *const k_horizontal_eighths[9] = {" ", "▏", "▎", "▍", "▌",
+                                                    "▋", "▊", "▉", "█"};
+static const char *const k_vertical_eighths[9] = {" ", "▁", "▂", "▃", "▄",
+                                                  "▅", "▆", "▇", "█"};
+
+static float to_db(float linear, float floor_db)
+{
+    if (linear <= 0.0f)
+        return floor_db;
+    return std::max(floor_db, 20.0f * std::log10(linear));
+}
+
+// Draws an ftxui_clap_meter straight into the screen's cells
+class meter_node : public ftxui::Node
+{
+  public:
+    explicit meter_node(const ftxui_clap_meter &meter) : meter_(meter) {}
+
+    void ComputeRequirement() override
+    {
+        requirement_ = ftxui::Requirement{};
+        requirement_.min_x = 1;
+        requirement_.min_y = 1;
+        if (meter_.options().vertical)
+        {
+            requirement_.flex_grow_y = 1;
+        }
+        else
+        {
+            requirement_.flex_grow_x = 1;
+        }
+    }
+
+    void Render(ftxui::Screen &screen) override
+    {
+        const auto &options = meter_.options();
+        bool vertical = options.vertical;
+
+        // Cells along the meter and across it
+        int length = vertical ? box_.y_max - box_.y_min + 1 : box_.x_max - box_.x_min + 1;
+        int thickness = vertical ? box_.x_max - box_.x_min + 1 : box_.y_max - box_.y_min + 1;
+        if (length <= 0 || thickness <= 0)
+            return;
+
+        float range = std::max(1e-3f, options.max_db - options.min_db);
+        auto position = [&](float db) {
+            return std::min(1.0f, std::max(0.0f, (db - options.min_db) / range));
+        };
+
+        int level_eighths = static_cast<int>(position(meter_.levelDb()) * length * 8 + 0.5f);
+        int level_cells = (level_eighths + 7) / 8;
+
+        // The peak marker only shows beyond the bar
+        int peak_cell = std::min(length - 1, static_cast<int>(position(meter_.peakDb()) * length));
+        bool show_peak = meter_.peakDb() > options.min_db && peak_cell >= level_cells;
+
+        const char *const *eighths = vertical ? k_vertical_eighths : k_horizontal_eighths;
+
+        for (int i = 0; i < length; ++i)
+        {
+            // Level at the far edge of this cell decides its color
+            float cell_db = options.min_db + range * static_cast<float>(i + 1) / length;
+            const ftxui::Color &color = cell_db > options.clip_db   ? options.clip_color
+                                        : cell_db > options.warn_db ? options.warn_color
+                                                                    : options.normal_color;
+
+            const char *glyph = eighths[std::min(8, std::max(0, level_eighths - i * 8))];
+            if (show_peak && i == peak_cell)
+            {
+                glyph = vertical ? "▔" : "▕";
+            }
+
+            for (int j = 0; j < thickness; ++j)
+            {
+                int x = vertical ? box_.x_min + j : box_.x_min + i;
+                int y = vertical ? box_.y_max - i : box_.y_min + j;
+
+                auto &pixel = screen.PixelAt(x, y);
+                pixel.character = glyph;
+                pixel.foreground_color = color;
+            }
+        }
+    }
+
+  private:
+    const ftxui_clap_meter &meter_;
+};
+
+} // namespace ftxui_clap_support
+
+ftxui_clap_meter::ftxui_clap_meter(ftxui_clap_meter_channel &channel, int index,
+                                   const ftxui_clap_meter_options &options)
+    : channel_(channel), index_(index), options_(options), level_db_(options.min_db),
+      peak_db_(options.min_db),
+      element_(std::make_shared<ftxui_clap_support::meter_node>(*this))
+{
+}
+
+void ftxui_clap_meter::update()
+{
+    float peak = 0.0f;
+    float rms = 0.0f;
+    channel_.take(index_, peak, rms);
+
+    auto now = std::chrono::steady_clock::now();
+    float elapsed = last_update_ == std::chrono::steady_clock::time_point{}
+                        ? 0.0f
+                        : std::chrono::duration<float>(now - last_update_).count();
+    last_update_ = now;
+
+    // The bar rises immediately and falls at the decay rate
+    float level_db = ftxui_clap_support::to_db(rms, options_.min_db);
+    level_db_ = std::max(level_db, level_db_ - options_.decay_db_per_second * elapsed);
+    level_db_ = std::max(level_db_, options_.min_db);
+
+    // The marker holds the highest peak, then falls like the bar
+    float peak_db = ftxui_clap_support::to_db(peak, options_.min_db);
+    if (peak_db >= peak_db_)
+    {
+        peak_db_ = peak_db;
+        peak_until_ = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                std::chrono::duration<float>(options_.peak_hold_seconds));
+    }
+    else if (now >= peak_until_)
+    {
+        peak_db_ = std::max(options_.min_db, peak_db_ - options_.decay_db_per_second * elapsed);
+    }
+}
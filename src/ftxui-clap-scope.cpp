@@ -0,0 +1,232 @@
+#include "ftxui-clap-support/ftxui-clap-scope.h"
+#include <ftxui/dom/node.hpp>
+#include <ftxui/screen/screen.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FTXUI_CLAP_SIMD_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define FTXUI_CLAP_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace ftxui_clap_support
+{
+
+// Minimum and maximum of a non-empty span of samples
+static void min_max(const float *samples, uint32_t count, float &lo, float &hi)
+{
+    uint32_t i = 0;
+
+#if defined(FTXUI_CLAP_SIMD_SSE2)
+    if (count >= 8)
+    {
+        __m128 vlo = _mm_loadu_ps(samples);
+        __m128 vhi = vlo;
+        for (i = 4; i + 4 <= count; i += 4)
+        {
+            __m128 v = _mm_loadu_ps(samples + i);
+            vlo = _mm_min_ps(vlo, v);
+            vhi = _mm_max_ps(vhi, v);
+        }
+
+        // Fold the four lanes into one
+        vlo = _mm_min_ps(vlo, _mm_shuffle_ps(vlo, vlo, _MM_SHUFFLE(1, 0, 3, 2)));
+        vhi = _mm_max_ps(vhi, _mm_shuffle_ps(vhi, vhi, _MM_SHUFFLE(1, 0, 3, 2)));
+        vlo = _mm_min_ss(vlo, _mm_shuffle_ps(vlo, vlo, _MM_SHUFFLE(2, 3, 0, 1)));
+        vhi = _mm_max_ss(vhi, _mm_shuffle_ps(vhi, vhi, _MM_SHUFFLE(2, 3, 0, 1)));
+        lo = _mm_cvtss_f32(vlo);
+        hi = _mm_cvtss_f32(vhi);
+    }
+    else
+#elif defined(FTXUI_CLAP_SIMD_NEON)
+    if (count >= 8)
+    {
+        float32x4_t vlo = vld1q_f32(samples);
+        float32x4_t vhi = vlo;
+        for (i = 4; i + 4 <= count; i += 4)
+        {
+            float32x4_t v = vld1q_f32(samples + i);
+            vlo = vminq_f32(vlo, v);
+            vhi = vmaxq_f32(vhi, v);
+        }
+
+        // Fold the four lanes into one
+        float32x2_t lo2 = vpmin_f32(vget_low_f32(vlo), vget_high_f32(vlo));
+        float32x2_t hi2 = vpmax_f32(vget_low_f32(vhi), vget_high_f32(vhi));
+        lo = vget_lane_f32(vpmin_f32(lo2, lo2), 0);
+        hi = vget_lane_f32(vpmax_f32(hi2, hi2), 0);
+    }
+    else
+#endif
+    {
+        lo = hi = samples[0];
+        i = 1;
+    }
+
+    for (; i < count; ++i)
+    {
+        lo = std::min(lo, samples[i]);
+        hi = std::max(hi, samples[i]);
+    }
+}
+
+// Braille dot bits by sub-row and sub-column within a cell
+static constexpr uint8_t k_braille_dots[4][2] = {
+    {0x01, 0x08}, {0x02, 0x10}, {0x04, 0x20}, {0x40, 0x80}};
+
+// Half blocks by upper (bit 0) and lower (bit 1) half
+static const char *const k_half_blocks[4] = {" ", "▀", "▄", "█"};
+
+// Draws an ftxui_clap_scope straight into the screen's cells
+class scope_node : public ftxui::Node
+{
+  public:
+    explicit scope_node(ftxui_clap_scope &scope) : scope_(scope) {}
+
+    void ComputeRequirement() override
+    {
+        requirement_ = ftxui::Requirement{};
+        requirement_.min_x = 1;
+        requirement_.min_y = 1;
+        requirement_.flex_grow_x = 1;
+        requirement_.flex_grow_y = 1;
+    }
+
+    void Render(ftxui::Screen &screen) override
+    {
+        const auto &options = scope_.options_;
+        int width = box_.x_max - box_.x_min + 1;
+        int height = box_.y_max - box_.y_min + 1;
+        if (width <= 0 || height <= 0)
+            return;
+
+        int dots_x = options.braille ? 2 : 1;
+        int dots_y = options.braille ? 4 : 2;
+        int columns = width * dots_x;
+        int rows = height * dots_y;
+
+        auto &cells = scope_.dots_;
+        cells.assign(static_cast<size_t>(width) * height, 0);
+
+        if (scope_.block_)
+        {
+            trace(columns, rows, dots_x, dots_y, width);
+        }
+
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                uint8_t bits = cells[static_cast<size_t>(y) * width + x];
+                auto &pixel = screen.PixelAt(box_.x_min + x, box_.y_min + y);
+                if (options.braille)
+                {
+                    // U+2800 + bits, encoded as UTF-8
+                    char glyph[4] = {'\xE2', static_cast<char>(0xA0 | (bits >> 6)),
+                                     static_cast<char>(0x80 | (bits & 0x3F)), '\0'};
+                    pixel.character = bits ? glyph : " ";
+                }
+                else
+                {
+                    pixel.character = k_half_blocks[bits & 0x3];
+                }
+                pixel.foreground_color = options.color;
+            }
+        }
+    }
+
+  private:
+    // Reduce the block to one extent per dot column and set the dots
+    void trace(int columns, int rows, int dots_x, int dots_y, int width)
+    {
+        const auto &options = scope_.options_;
+        auto &mins = scope_.mins_;
+        auto &maxs = scope_.maxs_;
+        mins.resize(columns);
+        maxs.resize(columns);
+        ftxui_clap_decimateMinMax(scope_.block_, scope_.channel_.blockSize(),
+                                  static_cast<uint32_t>(columns), mins.data(), maxs.data());
+
+        float range = options.max_value - options.min_value;
+        if (range == 0.0f)
+            range = 1.0f;
+        auto to_row = [&](float value) {
+            float position = (options.max_value - value) / range * static_cast<float>(rows - 1);
+            return std::min(rows - 1, std::max(0, static_cast<int>(position + 0.5f)));
+        };
+
+        int previous_top = 0;
+        int previous_bottom = 0;
+        for (int x = 0; x < columns; ++x)
+        {
+            int top = to_row(maxs[x]);
+            int bottom = to_row(mins[x]);
+
+            // Join with the previous column so that steep edges stay
+            // connected
+            if (x > 0)
+            {
+                top = std::min(top, previous_bottom);
+                bottom = std::max(bottom, previous_top);
+            }
+            previous_top = top;
+            previous_bottom = bottom;
+
+            int cell_x = x / dots_x;
+            for (int y = top; y <= bottom; ++y)
+            {
+                uint8_t bit = dots_x == 2 ? k_braille_dots[y % 4][x % 2]
+                                          : static_cast<uint8_t>(1 << (y % 2));
+                scope_.dots_[static_cast<size_t>(y / dots_y) * width + cell_x] |= bit;
+            }
+        }
+    }
+
+    ftxui_clap_scope &scope_;
+};
+
+} // namespace ftxui_clap_support
+
+void ftxui_clap_decimateMinMax(const float *samples, uint32_t count, uint32_t columns, float *mins,
+                               float *maxs)
+{
+    if (!mins || !maxs)
+        return;
+
+    if (!samples || count == 0)
+    {
+        std::fill(mins, mins + columns, 0.0f);
+        std::fill(maxs, maxs + columns, 0.0f);
+        return;
+    }
+
+    for (uint32_t c = 0; c < columns; ++c)
+    {
+        auto begin = static_cast<uint32_t>(uint64_t(c) * count / columns);
+        auto end = static_cast<uint32_t>(uint64_t(c + 1) * count / columns);
+        if (end <= begin)
+        {
+            mins[c] = maxs[c] = samples[std::min(begin, count - 1)];
+            continue;
+        }
+
+        ftxui_clap_support::min_max(samples + begin, end - begin, mins[c], maxs[c]);
+    }
+}
+
+ftxui_clap_scope::ftxui_clap_scope(ftxui_clap_scope_channel &channel,
+                                   const ftxui_clap_scope_options &options)
+    : channel_(channel), options_(options),
+      element_(std::make_shared<ftxui_clap_support::scope_node>(*this))
+{
+}
+
+void ftxui_clap_scope::update()
+{
+    // Keep showing the previous block until a new one is complete
+    if (const float *block = channel_.take())
+    {
+        block_ = block;
+    }
+}
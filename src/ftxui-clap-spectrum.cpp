@@ -0,0 +1,399 @@
+#include "ftxui-clap-support/ftxui-clap-spectrum.h"
+#include "ftxui-clap-support/ftxui-clap-triple-buffer.h"
+#include "fft.h"
+#include "wakeup-event.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <ftxui/dom/node.hpp>
+#include <ftxui/screen/screen.hpp>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ftxui_clap_support
+{
+
+// Widest view the worker produces columns for
+static constexpr int k_max_columns = 1024;
+
+static size_t round_up_power_of_two(size_t value, size_t minimum, size_t maximum)
+{
+    size_t size = minimum;
+    while (size < value && size < maximum)
+    {
+        size *= 2;
+    }
+    return size;
+}
+
+// Finished analysis handed from the worker to the view
+struct spectrum_levels
+{
+    std::vector<float> db;
+    int count = 0;
+};
+
+class spectrum_worker
+{
+  public:
+    explicit spectrum_worker(const ftxui_clap_spectrum_options &options);
+    ~spectrum_worker();
+
+    // Audio thread
+    void push(const float *samples, uint32_t count);
+
+    void set_sample_rate(double sample_rate)
+    {
+        sample_rate_.store(sample_rate, std::memory_order_relaxed);
+    }
+
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    // View: start the worker thread for the first attached view
+    void attach();
+
+    // View: number of columns to produce from now on
+    void request_columns(int count)
+    {
+        columns_.store(std::min(count, k_max_columns), std::memory_order_relaxed);
+    }
+
+    // View: newest analysis, or nullptr if there is none since the last call
+    const spectrum_levels *take() { return output_.take(); }
+
+  private:
+    void run();
+    void analyze();
+    void map_columns(int count, double sample_rate);
+
+    ftxui_clap_spectrum_options options_;
+    size_t fft_size_;
+    size_t hop_size_;
+
+    // Audio thread to worker: single-producer, single-consumer sample queue
+    std::unique_ptr<float[]> queue_;
+    size_t queue_mask_;
+    alignas(64) std::atomic<size_t> write_{0};
+    alignas(64) std::atomic<size_t> read_{0};
+    std::atomic<uint64_t> dropped_{0};
+
+    std::atomic<double> sample_rate_;
+    std::atomic<int> columns_{0};
+
+    wakeup_event wakeup_;
+    std::atomic<bool> stop_{false};
+
+    // Set once a view is attached; until then there is no thread and the
+    // audio thread ignores pushed samples
+    std::once_flag start_;
+    std::atomic<bool> attached_{false};
+
+    // Owned by the worker
+    fft fft_;
+    std::vector<float> window_;
+    std::vector<float> history_;
+    size_t history_pos_ = 0;
+    std::vector<float> re_;
+    std::vector<float> im_;
+    std::vector<float> power_;
+    std::vector<float> edges_;
+    int mapped_columns_ = 0;
+    double mapped_rate_ = 0.0;
+
+    ftxui_clap_triple_buffer<spectrum_levels> output_;
+
+    std::thread thread_;
+};
+
+spectrum_worker::spectrum_worker(const ftxui_clap_spectrum_options &options)
+    : options_(options), fft_size_(round_up_power_of_two(options.fft_size, 64, 16384)),
+      hop_size_(options.hop_size ? std::min<size_t>(options.hop_size, fft_size_) : fft_size_ / 4),
+      queue_mask_(round_up_power_of_two(options.queue_size ? options.queue_size : fft_size_ * 4,
+                                        fft_size_, size_t(1) << 20) -
+                  1),
+      sample_rate_(options.sample_rate > 0.0 ? options.sample_rate : 48000.0), fft_(fft_size_),
+      window_(fft_size_), history_(fft_size_, 0.0f), re_(fft_size_), im_(fft_size_),
+      power_(fft_size_ / 2 + 1, 0.0f), edges_(k_max_columns + 1)
+{
+    queue_ = std::make_unique<float[]>(queue_mask_ + 1);
+
+    const double pi = 3.14159265358979323846;
+    for (size_t i = 0; i < fft_size_; ++i)
+    {
+        window_[i] = static_cast<float>(
+            0.5 - 0.5 * std::cos(2.0 * pi * static_cast<double>(i) / fft_size_));
+    }
+
+    // Publishing never has to allocate
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        output_.slot(i).db.reserve(k_max_columns);
+    }
+}
+
+spectrum_worker::~spectrum_worker()
+{
+    if (thread_.joinable())
+    {
+        stop_ = true;
+        wakeup_.signal();
+        thread_.join();
+    }
+}
+
+void spectrum_worker::attach()
+{
+    std::call_once(start_, [this] {
+        thread_ = std::thread(&spectrum_worker::run, this);
+        attached_.store(true, std::memory_order_release);
+    });
+}
+
+void spectrum_worker::push(const float *samples, uint32_t count)
+{
+    // Nobody would look at the analysis
+    if (!attached_.load(std::memory_order_acquire))
+        return;
+
+    size_t write = write_.load(std::memory_order_relaxed);
+    size_t read = read_.load(std::memory_order_acquire);
+
+    size_t capacity = queue_mask_ + 1;
+    size_t room = capacity - (write - read);
+    if (count > room)
+    {
+        dropped_.fetch_add(count - room, std::memory_order_relaxed);
+        count = static_cast<uint32_t>(room);
+    }
+
+    // Copy in at most two pieces around the end of the queue
+    size_t offset = write & queue_mask_;
+    size_t first = std::min<size_t>(count, capacity - offset);
+    std::memcpy(queue_.get() + offset, samples, first * sizeof(float));
+    std::memcpy(queue_.get(), samples + first, (count - first) * sizeof(float));
+    write_.store(write + count, std::memory_order_release);
+
+    // Only wake the worker once a full hop is waiting
+    if (write + count - read >= hop_size_)
+    {
+        wakeup_.signal();
+    }
+}
+
+void spectrum_worker::run()
+{
+    while (true)
+    {
+        wakeup_.wait();
+        if (stop_)
+            return;
+
+        size_t read = read_.load(std::memory_order_relaxed);
+        size_t available = write_.load(std::memory_order_acquire) - read;
+        if (available < hop_size_)
+            continue;
+
+        // Move every complete hop into the history; when the worker fell
+        // behind only the newest window is analyzed
+        while (available >= hop_size_)
+        {
+            for (size_t i = 0; i < hop_size_; ++i)
+            {
+                history_[history_pos_] = queue_[(read + i) & queue_mask_];
+                history_pos_ = (history_pos_ + 1) & (fft_size_ - 1);
+            }
+            read += hop_size_;
+            available -= hop_size_;
+        }
+        read_.store(read, std::memory_order_release);
+
+        analyze();
+    }
+}
+
+void spectrum_worker::map_columns(int count, double sample_rate)
+{
+    // Column c spans [edges_[c], edges_[c + 1]) in fractional FFT bins
+    double min_hz = std::max(1.0f, options_.min_hz);
+    double max_hz = std::max<double>(min_hz * 1.01, options_.max_hz);
+    double nyquist_bin = static_cast<double>(fft_size_ / 2);
+    for (int c = 0; c <= count; ++c)
+    {
+        double hz = min_hz * std::pow(max_hz / min_hz, static_cast<double>(c) / count);
+        edges_[c] = static_cast<float>(std::min(nyquist_bin, hz * fft_size_ / sample_rate));
+    }
+
+    mapped_columns_ = count;
+    mapped_rate_ = sample_rate;
+}
+
+void spectrum_worker::analyze()
+{
+    // Until a view has drawn once there is no width to analyze for
+    int columns = columns_.load(std::memory_order_relaxed);
+    if (columns <= 0)
+        return;
+
+    // Window the history, oldest sample first
+    for (size_t i = 0; i < fft_size_; ++i)
+    {
+        re_[i] = history_[(history_pos_ + i) & (fft_size_ - 1)] * window_[i];
+        im_[i] = 0.0f;
+    }
+
+    fft_.forward(re_.data(), im_.data());
+
+    // Power relative to a full-scale sine through the Hann window; levels
+    // rise at once and fall by the smoothing factor
+    float scale = 4.0f / static_cast<float>(fft_size_);
+    scale *= scale;
+    float keep = std::min(0.99f, std::max(0.0f, options_.smoothing));
+    for (size_t bin = 0; bin < power_.size(); ++bin)
+    {
+        float power = (re_[bin] * re_[bin] + im_[bin] * im_[bin]) * scale;
+        float &smoothed = power_[bin];
+        smoothed = power >= smoothed ? power : smoothed * keep + power * (1.0f - keep);
+    }
+
+    double sample_rate = sample_rate_.load(std::memory_order_relaxed);
+    if (columns != mapped_columns_ || sample_rate != mapped_rate_)
+    {
+        map_columns(columns, sample_rate);
+    }
+
+    auto &levels = output_.back();
+    levels.db.resize(columns);
+    levels.count = columns;
+
+    int last_bin = static_cast<int>(power_.size()) - 1;
+    for (int c = 0; c < columns; ++c)
+    {
+        float begin = edges_[c];
+        float end = edges_[c + 1];
+        int first = static_cast<int>(std::ceil(begin));
+        int last = std::min(last_bin, static_cast<int>(std::floor(end)));
+
+        float power = 0.0f;
+        if (first <= last)
+        {
+            // Wide columns at high frequencies show their loudest bin
+            power = *std::max_element(power_.begin() + first, power_.begin() + last + 1);
+        }
+        else
+        {
+            // Narrow columns at low frequencies interpolate between bins
+            float center = 0.5f * (begin + end);
+            int bin = std::min(last_bin, static_cast<int>(center));
+            int next = std::min(last_bin, bin + 1);
+            float fraction = center - static_cast<float>(bin);
+            power = power_[bin] + (power_[next] - power_[bin]) * fraction;
+        }
+
+        levels.db[c] = 10.0f * std::log10(power + 1e-20f);
+    }
+
+    output_.publish();
+}
+
+// Partial blocks from one to eight eighths of a cell, bottom-up
+static const char *const k_vertical_eighths[9] = {" ", "▁", "▂", "▃", "▄",
+                                                  "▅", "▆", "▇", "█"};
+
+// Draws an ftxui_clap_spectrum straight into the screen's cells
+class spectrum_node : public ftxui::Node
+{
+  public:
+    explicit spectrum_node(ftxui_clap_spectrum &view) : view_(view) {}
+
+    void ComputeRequirement() override
+    {
+        requirement_ = ftxui::Requirement{};
+        requirement_.min_x = 1;
+        requirement_.min_y = 1;
+        requirement_.flex_grow_x = 1;
+        requirement_.flex_grow_y = 1;
+    }
+
+    void Render(ftxui::Screen &screen) override
+    {
+        const auto &options = view_.options_;
+        int width = box_.x_max - box_.x_min + 1;
+        int height = box_.y_max - box_.y_min + 1;
+        if (width <= 0 || height <= 0)
+            return;
+
+        // The next analyses are reduced to exactly this many columns
+        view_.worker_.request_columns(width);
+
+        float range = std::max(1e-3f, options.max_db - options.min_db);
+        for (int x = 0; x < width; ++x)
+        {
+            int eighths = 0;
+            if (view_.levels_ && view_.level_count_ > 0)
+            {
+                // Until an analysis for the new width arrives, stretch the old
+                int column = x * view_.level_count_ / width;
+                float position = (view_.levels_[column] - options.min_db) / range;
+                position = std::min(1.0f, std::max(0.0f, position));
+                eighths = static_cast<int>(position * height * 8 + 0.5f);
+            }
+
+            for (int y = 0; y < height; ++y)
+            {
+                auto &pixel = screen.PixelAt(box_.x_min + x, box_.y_max - y);
+                pixel.character = k_vertical_eighths[std::min(8, std::max(0, eighths - y * 8))];
+                pixel.foreground_color = options.color;
+            }
+        }
+    }
+
+  private:
+    ftxui_clap_spectrum &view_;
+};
+
+} // namespace ftxui_clap_support
+
+ftxui_clap_spectrum_analyzer::ftxui_clap_spectrum_analyzer(
+    const ftxui_clap_spectrum_options &options)
+    : worker_(std::make_unique<ftxui_clap_support::spectrum_worker>(options))
+{
+}
+
+ftxui_clap_spectrum_analyzer::~ftxui_clap_spectrum_analyzer() = default;
+
+void ftxui_clap_spectrum_analyzer::push(const float *samples, uint32_t count)
+{
+    if (samples && count > 0)
+    {
+        worker_->push(samples, count);
+    }
+}
+
+void ftxui_clap_spectrum_analyzer::setSampleRate(double sample_rate)
+{
+    if (sample_rate > 0.0)
+    {
+        worker_->set_sample_rate(sample_rate);
+    }
+}
+
+uint64_t ftxui_clap_spectrum_analyzer::droppedSamples() const { return worker_->dropped(); }
+
+ftxui_clap_spectrum::ftxui_clap_spectrum(ftxui_clap_spectrum_analyzer &analyzer,
+                                         const ftxui_clap_spectrum_view_options &options)
+    : worker_(*analyzer.worker_), options_(options),
+      element_(std::make_shared<ftxui_clap_support::spectrum_node>(*this))
+{
+    worker_.attach();
+}
+
+void ftxui_clap_spectrum::update()
+{
+    if (auto levels = worker_.take())
+    {
+        levels_ = levels->db.data();
+        level_count_ = levels->count;
+    }
+}
@@ -1,14 +1,21 @@
 #include "embedded-terminal.h"
+#include "frame-mailbox.h"
+#include "latency-histogram.h"
+#include "clap/ext/params.h"
 #include "ftxui-clap-support/ftxui-clap-editor.h"
+#include "parameter-channels.h"
+#include "render-pool.h"
+#include "terminal-frame.h"
+#include "wakeup-event.h"
 #include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <ftxui/component/component.hpp>
 #include <ftxui/component/screen_interactive.hpp>
 #include <ftxui/dom/elements.hpp>
 #include <ftxui/screen/screen.hpp>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <thread>
 
 namespace ftxui_clap_support
@@ -19,11 +26,96 @@ struct FTXUIContext
 {
     ftxui_clap_editor *editor;
     ftxui::Component component;
-    int cols = 80;
-    int rows = 24;
-    bool visible = false;
+    // Written by the host thread, read by the render stage
+    std::atomic<int> cols{80};
+    std::atomic<int> rows{24};
+    std::atomic<bool> visible{false};
+
+    // Options the GUI was created with
+    ftxui_clap_terminal_options options;
+
+    // Host timer driving this editor on the main thread, if the host
+    // supports it; otherwise the editor is served by the render thread. The
+    // timer is registered while the editor is shown. host_timer is what the
+    // render thread reads; it only ever goes from true to false, when the
+    // host refuses to register the timer.
+    const clap_host_t *host = nullptr;
+    const clap_host_timer_support_t *timer = nullptr;
+    clap_id timer_id = CLAP_INVALID_ID;
+    std::atomic<bool> host_timer{false};
+
+    bool host_driven() const { return host_timer.load(std::memory_order_acquire); }
+
+    // Dirty tracking: anything that can change what the editor shows bumps
+    // generation, and the render thread skips editors whose generation has
+    // not moved since the last rendered frame
+    std::atomic<uint64_t> generation{1};
+    uint64_t rendered_generation = 0;
+
+    // Set when the platform window needs the whole next frame even if no
+    // cell changed (new window, re-shown window)
+    std::atomic<bool> force_present{true};
+
+    // Cell grid reused across frames; only reallocated when the size changes
+    std::unique_ptr<ftxui::Screen> screen;
+
+    // Frames travel from the render stage to the window through this
+    // mailbox; the render stage never waits for presentation
+    std::shared_ptr<frame_mailbox> mailbox = std::make_shared<frame_mailbox>();
+    uint64_t published_sequence = 0;
+    bool published = false;
+
+    // Key of the editor's window in the embedded terminal
+    std::string window_id;
+
+    // Parent handed over by the host. The embedded window only exists while
+    // the terminal is up, so it is (re)created from this handle on show.
+    void *parent_handle = nullptr;
+    bool has_window = false;
+
+    // Frame pacing: a dirty editor is rendered no earlier than next_frame,
+    // which advances by frame_interval after each render
+    std::chrono::steady_clock::duration frame_interval = std::chrono::milliseconds(33);
+    std::chrono::steady_clock::time_point next_frame{};
+
+    // Coalescing: an idle editor that becomes dirty is rendered
+    // coalescing_window after the scheduler first saw the change, so that a
+    // burst of changes lands in one frame. dirty_since is cleared by each
+    // render.
+    std::chrono::steady_clock::duration coalescing_window{};
+    std::chrono::steady_clock::time_point dirty_since{};
+
+    // steady_clock time of the oldest audio-side change waiting for the
+    // next present, 0 if none
+    int64_t change_stamp = 0;
+
+    // Used to ask for a parameter flush after UI edits, if the host has it
+    const clap_host_params_t *host_params = nullptr;
+
+    // Audio-side generation of the editor's channels as of the last
+    // delivery
+    uint64_t audio_generation = 0;
+
+    // Changes collected for the next onParameterChanges() call; the storage
+    // is kept across frames
+    std::vector<ftxui_clap_param_change> parameter_changes;
+
+    // Input events posted from the host side, dispatched on the render thread
+    std::mutex event_mutex;
+    std::vector<ftxui::Event> pending_events;
+
+    FTXUIContext(ftxui_clap_editor *ed, const ftxui_clap_terminal_options &opts)
+        : editor(ed), options(opts),
+          window_id(std::to_string(reinterpret_cast<uintptr_t>(ed)))
+    {
+        int fps = std::max(1, std::min(240, options.target_fps));
+        frame_interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(1.0 / fps));
 
-    FTXUIContext(ftxui_clap_editor *ed) : editor(ed) {}
+        double window_ms = std::max(0.0, std::min(1000.0, double(options.coalescing_window_ms)));
+        coalescing_window = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double, std::milli>(window_ms));
+    }
 };
 
 // Global state for managing editors and the embedded terminal
@@ -33,68 +125,346 @@ static std::vector<ftxui_clap_editor *> g_active_editors;
 static std::thread g_render_thread;
 static std::atomic<bool> g_should_stop{false};
 
-// Thread-safe parameter update queue
-struct parameter_update
+// The render thread sleeps on this until something needs a new frame
+static wakeup_event g_render_wakeup;
+
+// Held by the render thread while it touches editor contexts, so that an
+// editor cannot be destroyed in the middle of a frame
+static std::mutex g_frame_mutex;
+
+// Number of shown editors. The display connection, fonts and the render
+// thread are only kept alive while this is non-zero, so a session full of
+// closed editors costs nothing. Only touched from the host's main thread.
+static int g_visible_editors = 0;
+
+// Time from an audio-side change to the present of the frame showing it
+static latency_histogram g_change_latency;
+
+// Number of threads rendering editors in parallel, 0 for automatic
+static std::atomic<unsigned> g_render_thread_count{0};
+
+// Parameter updates dropped because an editor's channels were full
+static std::atomic<uint64_t> g_dropped_parameter_updates{0};
+
+// UI edits that never reached the host: the edit queue was full, or the
+// host's output event list rejected them
+static std::atomic<uint64_t> g_dropped_parameter_edits{0};
+
+// Mark an editor as changed; it is rendered at its next deadline
+void invalidate(FTXUIContext *ctx)
 {
-    uint32_t param_id;
-    double value;
-    ftxui_clap_editor *editor;
-};
+    ctx->generation.fetch_add(1, std::memory_order_release);
+    g_render_wakeup.signal();
+}
 
-static std::queue<parameter_update> g_parameter_queue;
-static std::mutex g_parameter_mutex;
+// Hand queued input events to the editor, then to its component tree
+static void dispatch_events(FTXUIContext *ctx)
+{
+    std::vector<ftxui::Event> events;
+    {
+        std::lock_guard<std::mutex> lock(ctx->event_mutex);
+        events.swap(ctx->pending_events);
+    }
 
-// Main rendering loop for the embedded terminal
-static void render_loop()
+    for (const auto &event : events)
+    {
+        if (!ctx->editor->onEvent(event) && ctx->component)
+        {
+            ctx->component->OnEvent(event);
+        }
+    }
+}
+
+// Render stage: lay out and rasterize one editor into frame_output. Runs on
+// a render pool worker, so it must only touch this editor's context.
+static void produce_frame(FTXUIContext *ctx)
 {
-    while (!g_should_stop)
+    int cols = ctx->cols.load(std::memory_order_relaxed);
+    int rows = ctx->rows.load(std::memory_order_relaxed);
+    if (!ctx->screen || ctx->screen->dimx() != cols || ctx->screen->dimy() != rows)
+    {
+        ctx->screen = std::make_unique<ftxui::Screen>(cols, rows);
+    }
+    else
+    {
+        // Resetting the cells in place keeps their storage
+        ctx->screen->Clear();
+    }
+
+    auto &screen = *ctx->screen;
+    ftxui::Render(screen, ctx->component->Render());
+
+    // Find the cells that changed since the last published frame. A dirty
+    // editor often differs in a handful of cells, or in none at all when a
+    // parameter update rounds to the same display value.
+    auto &slot = ctx->mailbox->back();
+    capture_frame(screen, slot.frame, ctx->options.enable_colors);
+    slot.damage.clear();
+
+    const mailbox_frame *previous = ctx->mailbox->lastPublished();
+    if (ctx->force_present.exchange(false, std::memory_order_acq_rel) || !previous)
+    {
+        full_damage(slot.frame, slot.damage);
+    }
+    else
+    {
+        diff_frames(previous->frame, slot.frame, slot.damage);
+    }
+
+    // Publish without waiting for the presenter; an unpresented older frame
+    // is simply replaced
+    ctx->published = !slot.damage.empty();
+    if (ctx->published)
     {
-        // Process parameter updates
+        slot.sequence = ++ctx->published_sequence;
+        ctx->mailbox->publish();
+    }
+}
+
+// Presentation stage: let the window pick up the newest published frame.
+// Runs serially, one editor at a time.
+static void present_frame(FTXUIContext *ctx)
+{
+    if (ctx->published && g_terminal)
+    {
+        g_terminal->present(ctx->window_id);
+    }
+}
+
+// Deliver the parameter updates queued for one editor in a single call,
+// however many arrived since its last frame
+static void deliver_parameter_updates(FTXUIContext *ctx, parameter_channels &channels)
+{
+    auto editor = ctx->editor;
+    auto &changes = ctx->parameter_changes;
+    if (!channels.collect(changes))
+    {
+        // Some updates were lost; have the editor re-read everything
+        editor->onParameterUpdate();
+    }
+    else if (!changes.empty())
+    {
+        editor->onParameterChanges(changes.data(), changes.size());
+    }
+
+    changes.clear();
+    ctx->generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Dispatch input to one editor and decide whether it needs a frame now.
+// Lowers next_deadline to the time a paced editor becomes due.
+static bool schedule_editor(FTXUIContext *ctx, std::chrono::steady_clock::time_point now,
+                            std::chrono::steady_clock::time_point &next_deadline,
+                            uint64_t &generation)
+{
+    dispatch_events(ctx);
+
+    // Hidden editors stay dirty; showing them invalidates anyway
+    if (!ctx->visible || !ctx->component)
+        return false;
+
+    // One load per side tells whether anything changed since the last frame
+    auto channels = channels_of(ctx->editor);
+    uint64_t audio_generation =
+        channels ? channels->generation.load(std::memory_order_acquire) : ctx->audio_generation;
+    bool audio_changed = audio_generation != ctx->audio_generation;
+
+    bool continuous = !ctx->options.use_dirty_tracking;
+    generation = ctx->generation.load(std::memory_order_acquire);
+    if (!continuous && !audio_changed && generation == ctx->rendered_generation)
+        return false;
+
+    // Host timer ticks already arrive at the frame rate. Otherwise the frame
+    // is due once the frame interval has passed and, for an editor that was
+    // idle, once the coalescing window since the change has closed.
+    if (!ctx->host_driven())
+    {
+        auto due = ctx->next_frame;
+        if (!continuous)
         {
-            std::lock_guard<std::mutex> lock(g_parameter_mutex);
-            while (!g_parameter_queue.empty())
+            if (ctx->dirty_since == std::chrono::steady_clock::time_point{})
             {
-                auto update = g_parameter_queue.front();
-                g_parameter_queue.pop();
-
-                if (update.editor)
-                {
-                    update.editor->onParameterUpdate();
-                }
+                ctx->dirty_since = now;
             }
+            due = std::max(due, ctx->dirty_since + ctx->coalescing_window);
+        }
+
+        if (now < due)
+        {
+            next_deadline = std::min(next_deadline, due);
+            return false;
         }
+    }
 
-        // Update all active editors
-        std::vector<ftxui_clap_editor *> active_editors;
+    // Parameter updates are only taken when the editor is about to be
+    // rendered, so everything that arrived since its last frame is
+    // delivered at once
+    if (audio_changed)
+    {
+        int64_t stamp = channels->first_change.exchange(0, std::memory_order_relaxed);
+        if (stamp && (!ctx->change_stamp || stamp < ctx->change_stamp))
         {
-            std::lock_guard<std::mutex> lock(g_editors_mutex);
-            active_editors = g_active_editors;
+            ctx->change_stamp = stamp;
         }
 
-        // Render each editor and update terminal
-        for (auto editor : active_editors)
+        ctx->audio_generation = audio_generation;
+        deliver_parameter_updates(ctx, *channels);
+        generation = ctx->generation.load(std::memory_order_acquire);
+    }
+
+    return true;
+}
+
+// Present a produced frame and advance the editor's pacing state
+static void complete_editor(FTXUIContext *ctx, std::chrono::steady_clock::time_point now,
+                            std::chrono::steady_clock::time_point &next_deadline,
+                            uint64_t generation)
+{
+    present_frame(ctx);
+
+    // A change that did not alter any cell was never presented
+    if (ctx->change_stamp)
+    {
+        if (ctx->published)
         {
-            if (!editor || !editor->ctx)
-                continue;
+            std::chrono::steady_clock::time_point changed(
+                std::chrono::steady_clock::duration(ctx->change_stamp));
+            g_change_latency.record(std::chrono::steady_clock::now() - changed);
+        }
+        ctx->change_stamp = 0;
+    }
+
+    // Changes made while rendering leave the editor dirty
+    ctx->rendered_generation = generation;
+    ctx->next_frame = now + ctx->frame_interval;
+    ctx->dirty_since = {};
+
+    if (!ctx->options.use_dirty_tracking)
+    {
+        next_deadline = std::min(next_deadline, ctx->next_frame);
+    }
+}
+
+static unsigned render_thread_count()
+{
+    unsigned count = g_render_thread_count.load(std::memory_order_relaxed);
+    if (count == 0)
+    {
+        // Leave most cores to the audio threads
+        count = std::max(1u, std::min(4u, std::thread::hardware_concurrency() / 2));
+    }
+    return count;
+}
 
-            auto ctx = static_cast<FTXUIContext *>(editor->ctx);
-            if (ctx->visible && ctx->component)
+// Main rendering loop for the editors that are not driven by a host timer
+//
+// Each editor keeps its own frame deadline derived from its target_fps. The
+// thread renders the editors that are dirty and whose deadline has passed,
+// then sleeps until the earliest remaining deadline, or until the next
+// invalidation if no editor is waiting. Editors created with
+// use_dirty_tracking disabled are treated as always dirty and animate at
+// their target_fps while visible.
+//
+// When several editors are due together their render stage is spread over
+// a small worker pool; presentation stays on this thread.
+static void render_loop()
+{
+    struct due_editor
+    {
+        FTXUIContext *ctx;
+        uint64_t generation;
+    };
+
+    std::unique_ptr<render_pool> pool;
+    std::vector<ftxui_clap_editor *> active_editors;
+    std::vector<due_editor> due;
+
+    while (!g_should_stop)
+    {
+        auto next_deadline = std::chrono::steady_clock::time_point::max();
+
+        {
+            std::lock_guard<std::mutex> frame_lock(g_frame_mutex);
+
+            // Update all active editors
+            {
+                std::lock_guard<std::mutex> lock(g_editors_mutex);
+                active_editors = g_active_editors;
+            }
+
+            auto now = std::chrono::steady_clock::now();
+
+            // Collect the editors that are due
+            due.clear();
+            for (auto editor : active_editors)
             {
-                auto screen = ftxui::Screen::Create(ftxui::Dimension::Fixed(ctx->cols),
-                                                    ftxui::Dimension::Fixed(ctx->rows));
-                ftxui::Render(screen, ctx->component->Render());
+                if (!editor || !editor->ctx)
+                    continue;
 
-                // Convert screen to string and send to terminal
-                std::string output = screen.ToString();
-                if (g_terminal)
+                auto ctx = static_cast<FTXUIContext *>(editor->ctx);
+                if (ctx->host_driven())
+                    continue;
+
+                uint64_t generation = 0;
+                if (schedule_editor(ctx, now, next_deadline, generation))
+                {
+                    due.push_back({ctx, generation});
+                }
+            }
+
+            // Render stage, in parallel when it pays off
+            unsigned threads = render_thread_count();
+            if (due.size() > 1 && threads > 1)
+            {
+                if (!pool || pool->participant_count() != threads)
+                {
+                    pool.reset();
+                    pool = std::make_unique<render_pool>(threads - 1);
+                }
+                pool->run(due.size(), [&](size_t i) { produce_frame(due[i].ctx); });
+            }
+            else
+            {
+                for (auto &entry : due)
                 {
-                    std::string editor_id = std::to_string(reinterpret_cast<uintptr_t>(editor));
-                    g_terminal->update_content(editor_id, output);
+                    produce_frame(entry.ctx);
                 }
             }
+
+            // Presentation stage, serialized on the display connection
+            for (auto &entry : due)
+            {
+                complete_editor(entry.ctx, now, next_deadline, entry.generation);
+            }
         }
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(16)); // ~60 FPS
+        // Sleep until a parameter update, input event, resize or explicit
+        // redraw request arrives, or until a paced editor becomes due. An
+        // idle session never wakes up here.
+        if (next_deadline == std::chrono::steady_clock::time_point::max())
+        {
+            g_render_wakeup.wait();
+        }
+        else
+        {
+            g_render_wakeup.wait_until(next_deadline);
+        }
+    }
+}
+
+// One host timer tick for an editor in host-timer mode, on the main thread.
+// The render thread never touches host-driven editors, and every other call
+// on this editor comes from the main thread too, so no frame lock is taken;
+// a tick is never held up by other editors' frames.
+void on_timer(FTXUIContext *ctx)
+{
+    auto now = std::chrono::steady_clock::now();
+    auto next_deadline = std::chrono::steady_clock::time_point::max();
+    uint64_t generation = 0;
+    if (schedule_editor(ctx, now, next_deadline, generation))
+    {
+        produce_frame(ctx);
+        complete_editor(ctx, now, next_deadline, generation);
     }
 }
 
@@ -114,9 +484,26 @@ bool initialize()
             return false;
         }
 
+        return true;
+    }
+    catch (const std::exception &)
+    {
+        return false;
+    }
+}
+
+// Start the render thread for editors without host timer support
+static bool ensure_render_thread()
+{
+    if (g_render_thread.joinable())
+    {
+        return true;
+    }
+
+    try
+    {
         g_should_stop = false;
         g_render_thread = std::thread(render_loop);
-
         return true;
     }
     catch (const std::exception &)
@@ -125,28 +512,123 @@ bool initialize()
     }
 }
 
-void shutdown()
+static void stop_render_thread()
 {
     g_should_stop = true;
+    g_render_wakeup.signal();
 
     if (g_render_thread.joinable())
     {
         g_render_thread.join();
     }
+}
+
+// Tear down the render thread and every platform resource. Editors keep
+// their parent handles and get new windows when they are shown again.
+static void release_terminal()
+{
+    stop_render_thread();
 
     {
         std::lock_guard<std::mutex> lock(g_editors_mutex);
-        g_active_editors.clear();
+        for (auto editor : g_active_editors)
+        {
+            if (editor && editor->ctx)
+            {
+                static_cast<FTXUIContext *>(editor->ctx)->has_window = false;
+            }
+        }
+    }
+
+    // Destroys the remaining windows and closes the display connection
+    g_terminal.reset();
+}
+
+// Create the editor's embedded window once both the terminal and a parent
+// are available
+static bool ensure_window(FTXUIContext *ctx)
+{
+    if (ctx->has_window)
+        return true;
+
+    if (!g_terminal || !ctx->parent_handle)
+        return false;
+
+    if (!g_terminal->create_window(ctx->window_id, ctx->parent_handle, 0, 0, ctx->cols * 8,
+                                   ctx->rows * 16, ctx->mailbox))
+    {
+        return false;
     }
 
+    ctx->has_window = true;
+    g_terminal->show_window(ctx->window_id, ctx->visible);
+
+    // The new window starts out empty
+    ctx->force_present = true;
+    invalidate(ctx);
+    return true;
+}
+
+// Register the host timer of a host-driven editor that is being shown. If
+// the host refuses, the editor moves to the render thread for good.
+static void start_host_timer(FTXUIContext *ctx)
+{
+    if (!ctx->host_driven() || ctx->timer_id != CLAP_INVALID_ID)
+        return;
+
+    auto period_ms = static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(ctx->frame_interval).count());
+    if (!ctx->timer->register_timer(ctx->host, std::max<uint32_t>(1, period_ms), &ctx->timer_id))
     {
-        std::lock_guard<std::mutex> lock(g_parameter_mutex);
-        while (!g_parameter_queue.empty())
-        {
-            g_parameter_queue.pop();
-        }
+        ctx->timer_id = CLAP_INVALID_ID;
+        ctx->host_timer = false;
     }
+}
 
+// A hidden editor does not tick the host's main thread
+static void stop_host_timer(FTXUIContext *ctx)
+{
+    if (ctx->timer_id == CLAP_INVALID_ID)
+        return;
+
+    if (ctx->timer->unregister_timer)
+    {
+        ctx->timer->unregister_timer(ctx->host, ctx->timer_id);
+    }
+    ctx->timer_id = CLAP_INVALID_ID;
+}
+
+// Drop an editor from the visible count, releasing everything with the
+// last one
+static void hide_editor(FTXUIContext *ctx)
+{
+    if (!ctx->visible)
+        return;
+
+    ctx->visible = false;
+    stop_host_timer(ctx);
+    if (g_terminal && ctx->has_window)
+    {
+        g_terminal->show_window(ctx->window_id, false);
+    }
+
+    if (--g_visible_editors == 0)
+    {
+        release_terminal();
+    }
+}
+
+void shutdown()
+{
+    stop_render_thread();
+
+    {
+        std::lock_guard<std::mutex> lock(g_editors_mutex);
+        g_active_editors.clear();
+    }
+
+
+    g_visible_editors = 0;
     g_terminal.reset();
 }
 
@@ -163,14 +645,37 @@ void unregister_editor(ftxui_clap_editor *editor)
                            g_active_editors.end());
 }
 
+// Safe to call from audio threads: wait-free and allocation-free, and only
+// touches the editor's own channels
 void queue_parameter_update(uint32_t param_id, double value, ftxui_clap_editor *editor)
 {
-    std::lock_guard<std::mutex> lock(g_parameter_mutex);
-    g_parameter_queue.push({param_id, value, editor});
+    // Without channels the editor never had a GUI, so there is nothing to
+    // update
+    auto channels = editor ? channels_of(editor) : nullptr;
+    if (!channels)
+        return;
+
+    auto result = channels->post(param_id, value);
+    if (!result.kept)
+    {
+        g_dropped_parameter_updates.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Later changes ride on the wakeup the first one sent, so a busy
+    // instance does not write the shared wakeup flag on every update
+    if (result.first)
+    {
+        g_render_wakeup.signal();
+    }
 }
 
 } // namespace ftxui_clap_support
 
+ftxui_clap_editor::~ftxui_clap_editor()
+{
+    delete ftxui_clap_support::channels_of(this);
+}
+
 // C API implementation for CLAP integration
 bool ftxui_clap_guiCreateWith(ftxui_clap_editor *editor, const clap_host_timer_support_t *timer,
                               const ftxui_clap_terminal_options *options)
@@ -179,26 +684,50 @@ bool ftxui_clap_guiCreateWith(ftxui_clap_editor *editor, const clap_host_timer_s
     if (!editor)
         return false;
 
-    // Initialize the library if needed
-    if (!ftxui_clap_support::initialize())
+    // No platform resources are acquired here; the display connection and
+    // the render thread wait for the first editor to be shown
+    // Create context for this editor
+    auto ctx = std::make_unique<ftxui_clap_support::FTXUIContext>(
+        editor, options ? *options : ftxui_clap_terminal_options{});
+
+    // Prefer rendering on the host's main-thread timer; the private render
+    // thread is only used when the host cannot provide one. The timer itself
+    // is registered on show.
+    if (timer && timer->register_timer && options && options->host)
     {
-        return false;
+        ctx->host = options->host;
+        ctx->timer = timer;
+        ctx->host_timer = true;
     }
 
-    // Create context for this editor
-    auto ctx = std::make_unique<ftxui_clap_support::FTXUIContext>(editor);
-    editor->ctx = ctx.release();
+    // The parameter channels outlive this GUI; the audio thread may use
+    // them at any time
+    auto capacity = static_cast<size_t>(std::max(1, ctx->options.parameter_capacity));
+    if (!ftxui_clap_support::channels_of(editor))
+    {
+        editor->parameters.store(new ftxui_clap_support::parameter_channels(capacity),
+                                 std::memory_order_release);
+    }
 
-    // Register editor
-    ftxui_clap_support::register_editor(editor);
+    if (options && options->host && options->host->get_extension)
+    {
+        ctx->host_params = static_cast<const clap_host_params_t *>(
+            options->host->get_extension(options->host, CLAP_EXT_PARAMS));
+    }
+    ctx->parameter_changes.reserve(capacity);
+
+    auto context = ctx.get();
+    editor->ctx = ctx.release();
 
     // Call editor's lifecycle callback
     editor->onGuiCreate();
 
     // Create the main component
-    auto context = static_cast<ftxui_clap_support::FTXUIContext *>(editor->ctx);
     context->component = editor->onCreateComponent();
 
+    // Register editor once it is ready to be rendered
+    ftxui_clap_support::register_editor(editor);
+
     return true;
 }
 
@@ -210,18 +739,26 @@ void ftxui_clap_guiDestroyWith(ftxui_clap_editor *editor, const clap_host_timer_
     // Call editor's lifecycle callback
     editor->onGuiDestroy();
 
+    auto ctx = static_cast<ftxui_clap_support::FTXUIContext *>(editor->ctx);
+
     // Clean up terminal window if it exists using global terminal
-    if (ftxui_clap_support::g_terminal)
+    if (ftxui_clap_support::g_terminal && ctx->has_window)
     {
-        std::string editor_id = std::to_string(reinterpret_cast<uintptr_t>(editor));
-        ftxui_clap_support::g_terminal->remove_editor(editor_id);
+        ftxui_clap_support::g_terminal->remove_editor(ctx->window_id);
+        ctx->has_window = false;
     }
 
+    // A destroyed editor no longer counts as shown; this may stop the render
+    // thread, so it must happen before taking the frame lock
+    ftxui_clap_support::hide_editor(ctx);
+
+    // Wait for an in-flight frame before tearing the context down
+    std::lock_guard<std::mutex> frame_lock(ftxui_clap_support::g_frame_mutex);
+
     // Unregister editor
     ftxui_clap_support::unregister_editor(editor);
 
-    // Clean up context
-    auto ctx = static_cast<ftxui_clap_support::FTXUIContext *>(editor->ctx);
+    // Clean up context; hiding it above already unregistered its timer
     delete ctx;
     editor->ctx = nullptr;
 }
@@ -233,14 +770,6 @@ bool ftxui_clap_guiSetParentWith(ftxui_clap_editor *editor, const clap_window *w
 
     auto ctx = static_cast<ftxui_clap_support::FTXUIContext *>(editor->ctx);
 
-    // Use the global terminal instead of creating a separate one
-    if (!ftxui_clap_support::g_terminal)
-    {
-        return false;
-    }
-
-    // Create terminal window with parent window
-    std::string editor_id = std::to_string(reinterpret_cast<uintptr_t>(editor));
     void *parent_handle = nullptr;
 
 #ifdef __APPLE__
@@ -248,16 +777,27 @@ bool ftxui_clap_guiSetParentWith(ftxui_clap_editor *editor, const clap_window *w
 #elif defined(_WIN32)
     parent_handle = window->win32;
 #elif defined(__linux__)
-    parent_handle = window->x11;
+    parent_handle = reinterpret_cast<void *>(window->x11);
 #endif
 
-    if (parent_handle)
+    if (!parent_handle)
+        return false;
+
+    // Remember the parent; the window itself is created on show, or right
+    // away when the terminal is already up. Reparenting replaces the window.
+    // The old window goes first, so a failed re-creation leaves none behind
+    if (ftxui_clap_support::g_terminal && ctx->has_window)
     {
-        return ftxui_clap_support::g_terminal->create_window(editor_id, parent_handle, 0, 0,
-                                                             ctx->cols * 8, ctx->rows * 16);
+        ftxui_clap_support::g_terminal->remove_editor(ctx->window_id);
+    }
+    ctx->parent_handle = parent_handle;
+    ctx->has_window = false;
+    if (ftxui_clap_support::g_terminal)
+    {
+        return ftxui_clap_support::ensure_window(ctx);
     }
 
-    return false;
+    return true;
 }
 
 bool ftxui_clap_guiSetSizeWith(ftxui_clap_editor *editor, int width, int height)
@@ -273,8 +813,8 @@ bool ftxui_clap_guiSetSizeWith(ftxui_clap_editor *editor, int width, int height)
     int rows = height / 16;
 
     // Apply constraints
-    cols = std::max(40, std::min(120, cols));
-    rows = std::max(10, std::min(40, rows));
+    cols = std::max(ctx->options.min_cols, std::min(ctx->options.max_cols, cols));
+    rows = std::max(ctx->options.min_rows, std::min(ctx->options.max_rows, rows));
 
     // Allow editor to adjust size
     if (!editor->adjustSize(cols, rows))
@@ -286,12 +826,15 @@ bool ftxui_clap_guiSetSizeWith(ftxui_clap_editor *editor, int width, int height)
     ctx->rows = rows;
 
     // Resize the window in the global terminal if it exists
-    if (ftxui_clap_support::g_terminal)
+    if (ftxui_clap_support::g_terminal && ctx->has_window)
     {
-        std::string editor_id = std::to_string(reinterpret_cast<uintptr_t>(editor));
-        ftxui_clap_support::g_terminal->resize_window(editor_id, cols * 8, rows * 16);
+        ftxui_clap_support::g_terminal->resize_window(ctx->window_id, cols * 8, rows * 16);
+
+        // A resized window has a new, empty back buffer
+        ctx->force_present = true;
     }
 
+    ftxui_clap_support::invalidate(ctx);
     return true;
 }
 
@@ -301,15 +844,45 @@ bool ftxui_clap_guiShowWith(ftxui_clap_editor *editor)
         return false;
 
     auto ctx = static_cast<ftxui_clap_support::FTXUIContext *>(editor->ctx);
-    ctx->visible = true;
+
+    // The first shown editor brings up the display connection and fonts,
+    // and the render thread unless the host drives this editor
+    if (!ftxui_clap_support::initialize())
+    {
+        return false;
+    }
+
+    ftxui_clap_support::start_host_timer(ctx);
+    if (!ctx->host_driven() && !ftxui_clap_support::ensure_render_thread())
+    {
+        return false;
+    }
+
+    if (!ctx->visible)
+    {
+        // Changes made while hidden could not be shown any sooner; latency
+        // is measured from the show on
+        if (auto channels = ftxui_clap_support::channels_of(editor))
+        {
+            channels->first_change.store(0, std::memory_order_relaxed);
+        }
+
+        ctx->visible = true;
+        ++ftxui_clap_support::g_visible_editors;
+    }
+    ctx->force_present = true;
 
     // Actually show the window using the global terminal
-    if (ftxui_clap_support::g_terminal)
+    if (ctx->has_window)
     {
-        std::string editor_id = std::to_string(reinterpret_cast<uintptr_t>(editor));
-        ftxui_clap_support::g_terminal->show_window(editor_id, true);
+        ftxui_clap_support::g_terminal->show_window(ctx->window_id, true);
+    }
+    else
+    {
+        ftxui_clap_support::ensure_window(ctx);
     }
 
+    ftxui_clap_support::invalidate(ctx);
     return true;
 }
 
@@ -318,19 +891,199 @@ bool ftxui_clap_guiHideWith(ftxui_clap_editor *editor)
     if (!editor || !editor->ctx)
         return false;
 
+    // Hiding the last shown editor releases the terminal and the render
+    // thread
     auto ctx = static_cast<ftxui_clap_support::FTXUIContext *>(editor->ctx);
-    ctx->visible = false;
+    ftxui_clap_support::hide_editor(ctx);
 
-    // Actually hide the window using the global terminal
-    if (ftxui_clap_support::g_terminal)
+    return true;
+}
+
+void ftxui_clap_guiRequestRedrawWith(ftxui_clap_editor *editor)
+{
+    if (!editor || !editor->ctx)
+        return;
+
+    auto ctx = static_cast<ftxui_clap_support::FTXUIContext *>(editor->ctx);
+    ftxui_clap_support::invalidate(ctx);
+}
+
+bool ftxui_clap_guiPostEventWith(ftxui_clap_editor *editor, const ftxui::Event &event)
+{
+    if (!editor || !editor->ctx)
+        return false;
+
+    auto ctx = static_cast<ftxui_clap_support::FTXUIContext *>(editor->ctx);
+    {
+        std::lock_guard<std::mutex> lock(ctx->event_mutex);
+        ctx->pending_events.push_back(event);
+    }
+
+    ftxui_clap_support::invalidate(ctx);
+    return true;
+}
+
+bool ftxui_clap_guiOnTimerWith(ftxui_clap_editor *editor, clap_id timer_id)
+{
+    if (!editor || !editor->ctx)
+        return false;
+
+    auto ctx = static_cast<ftxui_clap_support::FTXUIContext *>(editor->ctx);
+    if (!ctx->host_driven() || ctx->timer_id != timer_id)
+        return false;
+
+    ftxui_clap_support::on_timer(ctx);
+    return true;
+}
+
+void ftxui_clap_audioRequestRedrawWith(ftxui_clap_editor *editor)
+{
+    auto channels = editor ? ftxui_clap_support::channels_of(editor) : nullptr;
+    if (!channels)
+        return;
+
+    if (channels->touch())
+    {
+        ftxui_clap_support::g_render_wakeup.signal();
+    }
+}
+
+bool ftxui_clap_getChangeLatencyStats(ftxui_clap_latency_stats &stats)
+{
+    const auto &histogram = ftxui_clap_support::g_change_latency;
+    stats.samples = histogram.sample_count();
+    stats.p50_ms = histogram.percentile_ms(0.50);
+    stats.p90_ms = histogram.percentile_ms(0.90);
+    stats.p99_ms = histogram.percentile_ms(0.99);
+    stats.max_ms = histogram.max_ms();
+    return stats.samples > 0;
+}
+
+void ftxui_clap_resetChangeLatencyStats() { ftxui_clap_support::g_change_latency.reset(); }
+
+uint64_t ftxui_clap_getDroppedParameterUpdateCount()
+{
+    return ftxui_clap_support::g_dropped_parameter_updates.load(std::memory_order_relaxed);
+}
+
+uint64_t ftxui_clap_getDroppedParameterEditCount()
+{
+    return ftxui_clap_support::g_dropped_parameter_edits.load(std::memory_order_relaxed);
+}
+
+void ftxui_clap_setRenderThreadCount(unsigned count)
+{
+    ftxui_clap_support::g_render_thread_count.store(count, std::memory_order_relaxed);
+}
+
+static bool push_parameter_edit(ftxui_clap_editor *editor, const ftxui_clap_param_edit &edit)
+{
+    if (!editor || !editor->ctx)
+        return false;
+
+    auto channels = ftxui_clap_support::channels_of(editor);
+    if (!channels)
+        return false;
+
+    if (!channels->edits.try_push(edit))
     {
-        std::string editor_id = std::to_string(reinterpret_cast<uintptr_t>(editor));
-        ftxui_clap_support::g_terminal->show_window(editor_id, false);
+        ftxui_clap_support::g_dropped_parameter_edits.fetch_add(1, std::memory_order_relaxed);
+        return false;
     }
 
+    // A plugin that is not processing only sees the edit once the host
+    // calls params.flush()
+    auto ctx = static_cast<ftxui_clap_support::FTXUIContext *>(editor->ctx);
+    if (ctx->host_params && ctx->host_params->request_flush)
+    {
+        ctx->host_params->request_flush(ctx->options.host);
+    }
     return true;
 }
 
+bool ftxui_clap_beginParameterGestureWith(ftxui_clap_editor *editor, clap_id param_id)
+{
+    return push_parameter_edit(editor, {ftxui_clap_param_edit::gesture_begin, param_id, 0.0});
+}
+
+bool ftxui_clap_editParameterWith(ftxui_clap_editor *editor, clap_id param_id, double value)
+{
+    return push_parameter_edit(editor, {ftxui_clap_param_edit::value_change, param_id, value});
+}
+
+bool ftxui_clap_endParameterGestureWith(ftxui_clap_editor *editor, clap_id param_id)
+{
+    return push_parameter_edit(editor, {ftxui_clap_param_edit::gesture_end, param_id, 0.0});
+}
+
+bool ftxui_clap_popParameterEditWith(ftxui_clap_editor *editor, ftxui_clap_param_edit &edit)
+{
+    auto channels = editor ? ftxui_clap_support::channels_of(editor) : nullptr;
+    return channels && channels->edits.pop(edit);
+}
+
+// Report one UI edit to the host; false if the output list rejected it
+static bool push_edit_event(const clap_output_events_t *out, const ftxui_clap_param_edit &edit)
+{
+    if (edit.kind == ftxui_clap_param_edit::value_change)
+    {
+        clap_event_param_value_t event{};
+        event.header.size = sizeof(event);
+        event.header.time = 0;
+        event.header.space_id = CLAP_CORE_EVENT_SPACE_ID;
+        event.header.type = CLAP_EVENT_PARAM_VALUE;
+        event.header.flags = 0;
+        event.param_id = edit.param_id;
+        event.cookie = nullptr;
+        event.note_id = -1;
+        event.port_index = -1;
+        event.channel = -1;
+        event.key = -1;
+        event.value = edit.value;
+        return out->try_push(out, &event.header);
+    }
+
+    clap_event_param_gesture_t event{};
+    event.header.size = sizeof(event);
+    event.header.time = 0;
+    event.header.space_id = CLAP_CORE_EVENT_SPACE_ID;
+    event.header.type = edit.kind == ftxui_clap_param_edit::gesture_begin
+                            ? CLAP_EVENT_PARAM_GESTURE_BEGIN
+                            : CLAP_EVENT_PARAM_GESTURE_END;
+    event.header.flags = 0;
+    event.param_id = edit.param_id;
+    return out->try_push(out, &event.header);
+}
+
+uint32_t ftxui_clap_flushParameterEditsWith(ftxui_clap_editor *editor,
+                                            const clap_output_events_t *out,
+                                            void (*apply)(void *user_data,
+                                                          const ftxui_clap_param_edit &edit),
+                                            void *user_data)
+{
+    uint32_t count = 0;
+    ftxui_clap_param_edit edit;
+    while (ftxui_clap_popParameterEditWith(editor, edit))
+    {
+        ++count;
+
+        // An edit the host did not take is not applied either, so the
+        // plugin's state never moves away from the host's automation
+        if (out && out->try_push && !push_edit_event(out, edit))
+        {
+            ftxui_clap_support::g_dropped_parameter_edits.fetch_add(1,
+                                                                    std::memory_order_relaxed);
+            continue;
+        }
+
+        if (apply)
+        {
+            apply(user_data, edit);
+        }
+    }
+    return count;
+}
+
 bool ftxui_clap_guiGetSizeWith(ftxui_clap_editor *editor, int &width, int &height)
 {
     if (!editor || !editor->ctx)
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace ftxui_clap_support {
+
+/**
+ * Fixed-resolution latency histogram.
+ *
+ * Samples fall into bucket_width buckets up to bucket_count * bucket_width;
+ * anything slower lands in the last bucket. Recording is a single relaxed
+ * increment, so it can stay enabled in production builds.
+ */
+class latency_histogram {
+public:
+  static constexpr size_t bucket_count = 2000;
+  static constexpr std::chrono::microseconds bucket_width{50};
+
+  void record(std::chrono::steady_clock::duration latency) {
+    auto micros =
+        std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+    size_t bucket =
+        micros <= 0 ? 0 : static_cast<size_t>(micros / bucket_width.count());
+    if (bucket >= bucket_count) {
+      bucket = bucket_count - 1;
+    }
+    buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void reset() {
+    for (auto &bucket : buckets_) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  uint64_t sample_count() const {
+    uint64_t total = 0;
+    for (const auto &bucket : buckets_) {
+      total += bucket.load(std::memory_order_relaxed);
+    }
+    return total;
+  }
+
+  // Upper bound, in milliseconds, of the bucket holding the given fraction
+  // of the samples (0.5 for the median). 0 without samples.
+  double percentile_ms(double fraction) const {
+    uint64_t total = sample_count();
+    if (total == 0) {
+      return 0.0;
+    }
+
+    auto rank = static_cast<uint64_t>(fraction * static_cast<double>(total));
+    if (rank >= total) {
+      rank = total - 1;
+    }
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < bucket_count; ++i) {
+      seen += buckets_[i].load(std::memory_order_relaxed);
+      if (seen > rank) {
+        return bucket_upper_ms(i);
+      }
+    }
+    return bucket_upper_ms(bucket_count - 1);
+  }
+
+  // Upper bound of the slowest non-empty bucket
+  double max_ms() const {
+    for (size_t i = bucket_count; i-- > 0;) {
+      if (buckets_[i].load(std::memory_order_relaxed)) {
+        return bucket_upper_ms(i);
+      }
+    }
+    return 0.0;
+  }
+
+private:
+  static double bucket_upper_ms(size_t bucket) {
+    return static_cast<double>((bucket + 1) * bucket_width.count()) / 1000.0;
+  }
+
+  std::atomic<uint32_t> buckets_[bucket_count] = {};
+};
+
+} // namespace ftxui_clap_support
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace ftxui_clap_support {
+
+/**
+ * Bounded multi-producer, single-consumer ring buffer for audio threads.
+ *
+ * try_push() never allocates or locks and finishes in a bounded number of
+ * steps: it gives up when the ring is full, or when it lost the race for a
+ * slot max_push_attempts times in a row. A failed push drops the element;
+ * the caller decides how to account for it. pop() must not be called from
+ * two threads at once.
+ *
+ * Every slot carries a sequence number that tells a producer whether the
+ * slot is free for its position, and the consumer whether it holds an
+ * element.
+ */
+template <typename T, size_t Capacity> class mpsc_ring {
+  static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                "mpsc_ring capacity must be a power of two");
+
+public:
+  static constexpr int max_push_attempts = 16;
+
+  mpsc_ring() {
+    for (size_t i = 0; i < Capacity; ++i) {
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  mpsc_ring(const mpsc_ring &) = delete;
+  mpsc_ring &operator=(const mpsc_ring &) = delete;
+
+  // Producer: append value, or return false if it was dropped
+  bool try_push(const T &value) {
+    size_t position = tail_.load(std::memory_order_relaxed);
+    for (int attempt = 0; attempt < max_push_attempts; ++attempt) {
+      slot &s = slots_[position & mask];
+      size_t sequence = s.sequence.load(std::memory_order_acquire);
+      auto distance = static_cast<intptr_t>(sequence - position);
+
+      if (distance == 0) {
+        // The slot is free for this position; claim it
+        if (tail_.compare_exchange_weak(position, position + 1,
+                                        std::memory_order_relaxed)) {
+          s.value = value;
+          s.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (distance < 0) {
+        // The consumer has not freed this slot yet: the ring is full
+        return false;
+      } else {
+        // Another producer took the position first
+        position = tail_.load(std::memory_order_relaxed);
+      }
+    }
+    return false;
+  }
+
+  // Consumer: take the oldest element, or return false if there is none.
+  // An element whose producer is still writing it counts as not there yet.
+  bool pop(T &value) {
+    slot &s = slots_[head_ & mask];
+    size_t sequence = s.sequence.load(std::memory_order_acquire);
+    if (sequence != head_ + 1) {
+      return false;
+    }
+
+    value = s.value;
+    s.sequence.store(head_ + Capacity, std::memory_order_release);
+    ++head_;
+    return true;
+  }
+
+private:
+  static constexpr size_t mask = Capacity - 1;
+
+  struct slot {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  slot slots_[Capacity];
+
+  // Shared by the producers
+  alignas(64) std::atomic<size_t> tail_{0};
+
+  // Owned by the consumer
+  alignas(64) size_t head_ = 0;
+};
+
+} // namespace ftxui_clap_support
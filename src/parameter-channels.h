@@ -0,0 +1,118 @@
+#pragma once
+
+#include "ftxui-clap-support/ftxui-clap-editor.h"
+#include "mpsc-ring.h"
+#include "parameter-table.h"
+#include <chrono>
+#include <vector>
+
+namespace ftxui_clap_support {
+
+/**
+ * Lock-free parameter traffic between one editor and the audio thread.
+ *
+ * Each editor has its own channels, so plugin instances never contend with
+ * each other on the audio path, and a busy instance cannot delay the
+ * others' updates.
+ *
+ * Owned by the editor rather than by its GUI context: it is created with
+ * the first GUI and lives until the editor is destroyed, so the audio
+ * thread can use it at any time without synchronizing with the GUI's
+ * lifetime.
+ */
+struct parameter_channels {
+  static constexpr size_t overflow_capacity = 256;
+  static constexpr size_t edit_capacity = 1024;
+
+  explicit parameter_channels(size_t parameter_capacity)
+      : values(parameter_capacity) {}
+
+  // Outcome of post()
+  struct post_result {
+    bool kept;  // false if the change had to be dropped
+    bool first; // first change since the UI last took them; see touch()
+  };
+
+  // Audio thread: record a parameter change for the UI. Wait-free and
+  // allocation-free.
+  post_result post(clap_id param_id, double value) {
+    bool kept = values.store(param_id, value);
+
+    // Ids the table has no room for are queued individually
+    if (!kept && overflow.try_push({param_id, value})) {
+      overflow_pending.store(true, std::memory_order_release);
+      kept = true;
+    }
+
+    if (!kept) {
+      lost.store(true, std::memory_order_release);
+    }
+
+    bool first = touch();
+    return {kept, first};
+  }
+
+  // Audio thread: note that something the editor shows has changed.
+  // Returns true for the first change since the UI last took them; only
+  // that one has to wake the render thread, later ones are picked up by
+  // the same frame.
+  bool touch() {
+    // Only the first change after a delivery reads the clock
+    bool first = false;
+    if (first_change.load(std::memory_order_relaxed) == 0) {
+      int64_t expected = 0;
+      first = first_change.compare_exchange_strong(
+          expected, std::chrono::steady_clock::now().time_since_epoch().count(),
+          std::memory_order_relaxed);
+    }
+    generation.fetch_add(1, std::memory_order_release);
+    return first;
+  }
+
+  // UI: append the changes posted since the last call, oldest first.
+  // Returns false if some changes were dropped in the meantime, in which case
+  // the editor has to re-read all of its parameters.
+  bool collect(std::vector<ftxui_clap_param_change> &changes) {
+    bool complete = !lost.exchange(false, std::memory_order_acquire);
+
+    if (overflow_pending.exchange(false, std::memory_order_acquire)) {
+      ftxui_clap_param_change change;
+      while (overflow.pop(change)) {
+        changes.push_back(change);
+      }
+    }
+
+    values.drain([&](clap_id param_id, double value) {
+      changes.push_back({param_id, value});
+    });
+    return complete;
+  }
+
+  // Audio thread to UI: latest value of every changed parameter, plus the
+  // changes that did not fit in the table
+  parameter_table values;
+  mpsc_ring<ftxui_clap_param_change, overflow_capacity> overflow;
+  std::atomic<bool> overflow_pending{false};
+  std::atomic<bool> lost{false};
+
+  // UI to audio thread: value changes and gesture boundaries, in order
+  mpsc_ring<ftxui_clap_param_edit, edit_capacity> edits;
+
+  // Bumped after every change posted from the audio side. The scheduler
+  // compares it with the last generation it saw, so an idle editor costs
+  // one load of a cache line that nothing else writes.
+  alignas(64) std::atomic<uint64_t> generation{0};
+
+  // steady_clock time of the oldest change not yet taken by the UI, 0 if
+  // none; used to measure change-to-present latency. The scheduler resets
+  // it on every delivery, so it gets a line of its own rather than
+  // invalidating the one it polls generation on.
+  alignas(64) std::atomic<int64_t> first_change{0};
+};
+
+inline parameter_channels *channels_of(const ftxui_clap_editor *editor) {
+  return static_cast<parameter_channels *>(
+      editor->parameters.load(std::memory_order_acquire));
+}
+
+} // namespace ftxui_clap_support
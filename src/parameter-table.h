@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace ftxui_clap_support {
+
+/**
+ * Last-value-wins parameter table shared between audio threads and the UI.
+ *
+ * Each parameter id owns one slot holding its latest value and one bit in a
+ * dirty bitset. A store from the audio thread is one value store and one
+ * bit set; however often a parameter changes between two frames, the UI
+ * sees it once, with its newest value. Draining therefore costs in the
+ * number of distinct parameters that changed, not in the event rate.
+ *
+ * Slots are claimed on first use by open addressing and never released, so
+ * capacity should comfortably exceed the plugin's parameter count.
+ */
+class parameter_table {
+public:
+  // Parameter ids are never CLAP_INVALID_ID, which marks free slots
+  static constexpr uint32_t empty_id = UINT32_MAX;
+
+  // Longest probe sequence a store walks before reporting the table full
+  static constexpr size_t max_probes = 64;
+
+  // capacity is rounded up to a power of two, at least 64
+  explicit parameter_table(size_t capacity) {
+    size_t size = 64;
+    while (size < capacity) {
+      size *= 2;
+    }
+
+    mask_ = size - 1;
+    slots_ = std::make_unique<slot[]>(size);
+    dirty_ = std::make_unique<std::atomic<uint64_t>[]>(size / 64);
+    for (size_t i = 0; i < size / 64; ++i) {
+      dirty_[i].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  parameter_table(const parameter_table &) = delete;
+  parameter_table &operator=(const parameter_table &) = delete;
+
+  // Producer: record the newest value of a parameter. Wait-free and
+  // allocation-free; returns false if no slot could be found for a new id.
+  bool store(uint32_t param_id, double value) {
+    size_t index = hash(param_id) & mask_;
+    for (size_t probe = 0; probe < max_probes && probe <= mask_; ++probe) {
+      slot &s = slots_[index];
+      uint32_t id = s.id.load(std::memory_order_acquire);
+      if (id == empty_id) {
+        // Claim the free slot, unless another producer just did
+        s.id.compare_exchange_strong(id, param_id, std::memory_order_acq_rel);
+        id = s.id.load(std::memory_order_acquire);
+      }
+
+      if (id == param_id) {
+        s.value.store(value, std::memory_order_relaxed);
+        dirty_[index / 64].fetch_or(uint64_t(1) << (index % 64),
+                                    std::memory_order_release);
+        pending_.store(true, std::memory_order_release);
+        return true;
+      }
+
+      index = (index + 1) & mask_;
+    }
+    return false;
+  }
+
+  // Consumer: call fn(param_id, value) once for every parameter stored since
+  // the previous drain. Returns whether anything changed. Must not be called
+  // from two threads at once.
+  template <typename Fn> bool drain(Fn &&fn) {
+    if (!pending_.exchange(false, std::memory_order_acquire)) {
+      return false;
+    }
+
+    bool changed = false;
+    for (size_t word = 0; word <= mask_ / 64; ++word) {
+      uint64_t bits = dirty_[word].exchange(0, std::memory_order_acquire);
+      while (bits) {
+        size_t index = word * 64 + count_trailing_zeros(bits);
+        bits &= bits - 1;
+
+        const slot &s = slots_[index];
+        fn(s.id.load(std::memory_order_relaxed),
+           s.value.load(std::memory_order_relaxed));
+        changed = true;
+      }
+    }
+    return changed;
+  }
+
+private:
+  struct slot {
+    std::atomic<uint32_t> id{empty_id};
+    std::atomic<double> value{0.0};
+  };
+
+  // Multiplying by an odd constant permutes the low bits, so ids below the
+  // capacity never collide
+  static size_t hash(uint32_t id) { return size_t(id) * 2654435761u; }
+
+  static size_t count_trailing_zeros(uint64_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<size_t>(__builtin_ctzll(bits));
+#else
+    size_t count = 0;
+    while (!(bits & 1)) {
+      bits >>= 1;
+      ++count;
+    }
+    return count;
+#endif
+  }
+
+  size_t mask_ = 0;
+  std::unique_ptr<slot[]> slots_;
+  std::unique_ptr<std::atomic<uint64_t>[]> dirty_;
+
+  // Set by producers after marking a slot dirty, so an idle drain does not
+  // scan the bitset
+  alignas(64) std::atomic<bool> pending_{false};
+};
+
+} // namespace ftxui_clap_support
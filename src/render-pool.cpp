@@ -0,0 +1,108 @@
+#include "render-pool.h"
+
+namespace ftxui_clap_support
+{
+
+render_pool::render_pool(unsigned worker_count)
+    : slices_(std::make_unique<slice[]>(worker_count + 1))
+{
+    workers_.reserve(worker_count);
+    for (unsigned i = 0; i < worker_count; ++i)
+    {
+        workers_.emplace_back(&render_pool::worker_main, this, i + 1);
+    }
+}
+
+render_pool::~render_pool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    start_cv_.notify_all();
+
+    for (auto &worker : workers_)
+    {
+        worker.join();
+    }
+}
+
+void render_pool::run(size_t count, const std::function<void(size_t)> &task)
+{
+    if (count == 0)
+        return;
+
+    unsigned participants = participant_count();
+
+    // Hand every participant an equal contiguous slice of the range
+    size_t begin = 0;
+    for (unsigned i = 0; i < participants; ++i)
+    {
+        size_t end = begin + (count - begin) / (participants - i);
+        slices_[i].end = end;
+        slices_[i].next.store(begin, std::memory_order_relaxed);
+        begin = end;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = &task;
+        busy_workers_ = static_cast<unsigned>(workers_.size());
+        ++batch_;
+    }
+    start_cv_.notify_all();
+
+    work(0);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this] { return busy_workers_ == 0; });
+    task_ = nullptr;
+}
+
+void render_pool::worker_main(unsigned index)
+{
+    uint64_t seen_batch = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            start_cv_.wait(lock, [&] { return stop_ || batch_ != seen_batch; });
+            if (stop_)
+                return;
+            seen_batch = batch_;
+        }
+
+        work(index);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--busy_workers_ == 0)
+            {
+                done_cv_.notify_one();
+            }
+        }
+    }
+}
+
+void render_pool::work(unsigned index)
+{
+    unsigned participants = participant_count();
+
+    // Own slice first, then steal from the others in round-robin order.
+    // Owner and thieves claim indices with the same fetch_add, so every
+    // index is handed out exactly once.
+    for (unsigned offset = 0; offset < participants; ++offset)
+    {
+        auto &victim = slices_[(index + offset) % participants];
+        while (true)
+        {
+            size_t i = victim.next.fetch_add(1, std::memory_order_relaxed);
+            if (i >= victim.end)
+                break;
+            (*task_)(i);
+        }
+    }
+}
+
+} // namespace ftxui_clap_support
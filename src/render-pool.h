@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ftxui_clap_support {
+
+/**
+ * Small fixed-size thread pool for rendering many editors in one frame.
+ *
+ * run() splits the index range into one contiguous slice per participant
+ * (the workers plus the calling thread). Each participant drains its own
+ * slice first and then steals remaining indices from the others, so a few
+ * expensive editors do not leave the other threads idle.
+ */
+class render_pool {
+public:
+  // worker_count additional threads; the caller of run() also participates
+  explicit render_pool(unsigned worker_count);
+  ~render_pool();
+
+  render_pool(const render_pool &) = delete;
+  render_pool &operator=(const render_pool &) = delete;
+
+  // Invoke task(i) for every i in [0, count) and wait for completion
+  void run(size_t count, const std::function<void(size_t)> &task);
+
+  unsigned participant_count() const {
+    return static_cast<unsigned>(workers_.size()) + 1;
+  }
+
+private:
+  struct alignas(64) slice {
+    std::atomic<size_t> next{0};
+    size_t end = 0;
+  };
+
+  void worker_main(unsigned index);
+  void work(unsigned index);
+
+  std::vector<std::thread> workers_;
+  std::unique_ptr<slice[]> slices_;
+
+  std::mutex mutex_;
+  std::condition_variable start_cv_;
+  std::condition_variable done_cv_;
+  uint64_t batch_ = 0;
+  unsigned busy_workers_ = 0;
+  bool stop_ = false;
+  const std::function<void(size_t)> *task_ = nullptr;
+};
+
+} // namespace ftxui_clap_support
@@ -0,0 +1,171 @@
+#include "software-raster.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FTXUI_CLAP_SIMD_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define FTXUI_CLAP_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace ftxui_clap_support
+{
+
+uint32_t glyph_atlas::add(const uint8_t *coverage, int width, int height, int pitch, int left,
+                          int top)
+{
+    glyph_mask mask;
+    mask.left = left;
+    mask.top = top;
+    mask.width = std::max(0, width);
+    mask.height = std::max(0, height);
+    mask.offset = coverage_.size();
+
+    coverage_.resize(coverage_.size() + static_cast<size_t>(mask.width) * mask.height);
+    for (int y = 0; y < mask.height; ++y)
+    {
+        std::memcpy(coverage_.data() + mask.offset + static_cast<size_t>(y) * mask.width,
+                    coverage + static_cast<ptrdiff_t>(y) * pitch, mask.width);
+    }
+
+    masks_.push_back(mask);
+    return static_cast<uint32_t>(masks_.size() - 1);
+}
+
+void glyph_atlas::clear()
+{
+    masks_.resize(1);
+    coverage_.clear();
+}
+
+// Intersection of a rectangle with the clip and the target
+static raster_rect clip_rect(const raster_target &target, const raster_rect &rect,
+                             const raster_rect &clip)
+{
+    int x0 = std::max({rect.x, clip.x, 0});
+    int y0 = std::max({rect.y, clip.y, 0});
+    int x1 = std::min({rect.x + rect.width, clip.x + clip.width, target.width});
+    int y1 = std::min({rect.y + rect.height, clip.y + clip.height, target.height});
+    return {x0, y0, std::max(0, x1 - x0), std::max(0, y1 - y0)};
+}
+
+void raster_fill(const raster_target &target, const raster_rect &rect, const raster_rect &clip,
+                 uint32_t rgb)
+{
+    raster_rect area = clip_rect(target, rect, clip);
+    for (int y = area.y; y < area.y + area.height; ++y)
+    {
+        uint32_t *row = target.pixels + static_cast<ptrdiff_t>(y) * target.stride + area.x;
+        std::fill(row, row + area.width, rgb);
+    }
+}
+
+void raster_glyph(const raster_target &target, const glyph_mask &mask, const uint8_t *coverage,
+                  int pen_x, int baseline, const raster_rect &clip, uint32_t rgb)
+{
+    raster_rect bounds = {pen_x + mask.left, baseline - mask.top, mask.width, mask.height};
+    raster_rect area = clip_rect(target, bounds, clip);
+    if (area.width <= 0 || area.height <= 0)
+        return;
+
+    for (int y = area.y; y < area.y + area.height; ++y)
+    {
+        const uint8_t *source =
+            coverage + static_cast<size_t>(y - bounds.y) * mask.width + (area.x - bounds.x);
+        uint32_t *row = target.pixels + static_cast<ptrdiff_t>(y) * target.stride + area.x;
+        raster_blend_row(row, source, area.width, rgb);
+    }
+}
+
+// (value + 127) / 255 for value <= 255 * 255, without a division
+static inline uint32_t div255(uint32_t value)
+{
+    value += 128;
+    return (value + (value >> 8)) >> 8;
+}
+
+void raster_blend_row(uint32_t *pixels, const uint8_t *coverage, int count, uint32_t rgb)
+{
+    int i = 0;
+
+#if defined(FTXUI_CLAP_SIMD_SSE2)
+    // Four pixels per step, channels widened to 16 bits:
+    // out = (dst * (255 - a) + src * a) / 255
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i full = _mm_set1_epi16(255);
+    const __m128i bias = _mm_set1_epi16(128);
+    const __m128i color = _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(rgb)), zero);
+    for (; i + 4 <= count; i += 4)
+    {
+        uint32_t alphas;
+        std::memcpy(&alphas, coverage + i, sizeof(alphas));
+        if (alphas == 0)
+            continue;
+
+        // a0 a0 a0 a0 a1 a1 a1 a1 ... as bytes, then widened per pixel pair
+        __m128i a = _mm_cvtsi32_si128(static_cast<int>(alphas));
+        a = _mm_unpacklo_epi8(a, a);
+        a = _mm_unpacklo_epi16(a, a);
+        __m128i a_lo = _mm_unpacklo_epi8(a, zero);
+        __m128i a_hi = _mm_unpackhi_epi8(a, zero);
+
+        __m128i dst = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pixels + i));
+        __m128i d_lo = _mm_unpacklo_epi8(dst, zero);
+        __m128i d_hi = _mm_unpackhi_epi8(dst, zero);
+
+        __m128i x_lo = _mm_add_epi16(_mm_mullo_epi16(d_lo, _mm_sub_epi16(full, a_lo)),
+                                     _mm_mullo_epi16(color, a_lo));
+        __m128i x_hi = _mm_add_epi16(_mm_mullo_epi16(d_hi, _mm_sub_epi16(full, a_hi)),
+                                     _mm_mullo_epi16(color, a_hi));
+        x_lo = _mm_add_epi16(x_lo, bias);
+        x_hi = _mm_add_epi16(x_hi, bias);
+        x_lo = _mm_srli_epi16(_mm_add_epi16(x_lo, _mm_srli_epi16(x_lo, 8)), 8);
+        x_hi = _mm_srli_epi16(_mm_add_epi16(x_hi, _mm_srli_epi16(x_hi, 8)), 8);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(pixels + i), _mm_packus_epi16(x_lo, x_hi));
+    }
+#elif defined(FTXUI_CLAP_SIMD_NEON)
+    // Two pixels per step, the same arithmetic with widening multiplies
+    const uint8x8_t color = vreinterpret_u8_u32(vdup_n_u32(rgb));
+    for (; i + 2 <= count; i += 2)
+    {
+        if ((coverage[i] | coverage[i + 1]) == 0)
+            continue;
+
+        uint8x8_t a = vreinterpret_u8_u32(vset_lane_u32(
+            0x01010101u * coverage[i + 1], vdup_n_u32(0x01010101u * coverage[i]), 1));
+
+        uint8x8_t dst = vreinterpret_u8_u32(vld1_u32(pixels + i));
+        uint16x8_t x = vmull_u8(dst, vsub_u8(vdup_n_u8(255), a));
+        x = vmlal_u8(x, color, a);
+        uint8x8_t out = vrshrn_n_u16(vrsraq_n_u16(x, x, 8), 8);
+        vst1_u32(pixels + i, vreinterpret_u32_u8(out));
+    }
+#endif
+
+    // Tail, and the whole row without SIMD
+    uint32_t r = (rgb >> 16) & 0xFF;
+    uint32_t g = (rgb >> 8) & 0xFF;
+    uint32_t b = rgb & 0xFF;
+    for (; i < count; ++i)
+    {
+        uint32_t a = coverage[i];
+        if (a == 0)
+            continue;
+        if (a == 255)
+        {
+            pixels[i] = rgb;
+            continue;
+        }
+
+        uint32_t dst = pixels[i];
+        uint32_t keep = 255 - a;
+        pixels[i] = (div255(((dst >> 16) & 0xFF) * keep + r * a) << 16) |
+                    (div255(((dst >> 8) & 0xFF) * keep + g * a) << 8) |
+                    div255((dst & 0xFF) * keep + b * a);
+    }
+}
+
+} // namespace ftxui_clap_support
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ftxui_clap_support {
+
+// Rectangle in pixels, [x, x + width) x [y, y + height)
+struct raster_rect {
+  int x = 0;
+  int y = 0;
+  int width = 0;
+  int height = 0;
+};
+
+// 32-bit 0x00RRGGBB pixels owned by the caller, stride in pixels
+struct raster_target {
+  uint32_t *pixels = nullptr;
+  int width = 0;
+  int height = 0;
+  int stride = 0;
+};
+
+// Antialiased glyph coverage, placed relative to the pen position
+struct glyph_mask {
+  int left = 0; // from the pen to the first column
+  int top = 0;  // from the baseline up to the first row
+  int width = 0;
+  int height = 0;
+  size_t offset = 0; // into the atlas's coverage bytes, rows packed
+};
+
+/**
+ * Prerasterized glyph coverage masks, stored back to back in one array.
+ *
+ * Masks are added once when a glyph is first drawn and referred to by id
+ * afterwards; id 0 is an empty mask.
+ */
+class glyph_atlas {
+public:
+  glyph_atlas() { masks_.emplace_back(); }
+
+  // Copy a coverage mask with rows pitch bytes apart; returns its id
+  uint32_t add(const uint8_t *coverage, int width, int height, int pitch,
+               int left, int top);
+
+  const glyph_mask &mask(uint32_t id) const { return masks_[id]; }
+  const uint8_t *coverage(const glyph_mask &mask) const {
+    return coverage_.data() + mask.offset;
+  }
+
+  size_t size() const { return masks_.size() - 1; }
+
+  // Drop every mask; previously returned ids become invalid
+  void clear();
+
+private:
+  std::vector<glyph_mask> masks_;
+  std::vector<uint8_t> coverage_;
+};
+
+// Fill the part of rect inside clip and the target with rgb
+void raster_fill(const raster_target &target, const raster_rect &rect,
+                 const raster_rect &clip, uint32_t rgb);
+
+// Blend rgb into the target through a glyph's coverage, with the pen at
+// (pen_x, baseline), touching only pixels inside clip
+void raster_glyph(const raster_target &target, const glyph_mask &mask,
+                  const uint8_t *coverage, int pen_x, int baseline,
+                  const raster_rect &clip, uint32_t rgb);
+
+// Blend rgb into count pixels, pixel i by coverage[i] / 255. Vectorized
+// with SSE2 or NEON where available.
+void raster_blend_row(uint32_t *pixels, const uint8_t *coverage, int count,
+                      uint32_t rgb);
+
+} // namespace ftxui_clap_support
@@ -0,0 +1,292 @@
+#include "terminal-frame.h"
+#include <ftxui/screen/screen.hpp>
+
+namespace ftxui_clap_support
+{
+
+// Spans separated by fewer unchanged cells than this are merged; drawing a
+// couple of extra cells is cheaper than another draw call
+static constexpr int k_damage_merge_gap = 2;
+
+// Decode the first codepoint of a UTF-8 grapheme. Empty strings are the
+// continuation of a wide character.
+static uint32_t decode_codepoint(const std::string &text)
+{
+    if (text.empty())
+        return 0;
+
+    auto bytes = reinterpret_cast<const unsigned char *>(text.data());
+    size_t size = text.size();
+    unsigned char lead = bytes[0];
+
+    if (lead < 0x80)
+        return lead;
+    if ((lead & 0xE0) == 0xC0 && size >= 2)
+        return ((lead & 0x1Fu) << 6) | (bytes[1] & 0x3Fu);
+    if ((lead & 0xF0) == 0xE0 && size >= 3)
+        return ((lead & 0x0Fu) << 12) | ((bytes[1] & 0x3Fu) << 6) | (bytes[2] & 0x3Fu);
+    if ((lead & 0xF8) == 0xF0 && size >= 4)
+        return ((lead & 0x07u) << 18) | ((bytes[1] & 0x3Fu) << 12) |
+               ((bytes[2] & 0x3Fu) << 6) | (bytes[3] & 0x3Fu);
+
+    return 0xFFFD;
+}
+
+// ftxui::Color keeps its value private; its SGR form is the only public view
+// of it. Parses "39", "91", "38;5;N" or "38;2;R;G;B" (and the 4x forms).
+static uint32_t pack_color(const ftxui::Color &color, bool background)
+{
+    std::string sgr = color.Print(background);
+
+    int values[5] = {0, 0, 0, 0, 0};
+    int count = 0;
+    for (char c : sgr)
+    {
+        if (c == ';')
+        {
+            if (++count == 5)
+                break;
+        }
+        else if (c >= '0' && c <= '9')
+        {
+            values[count] = values[count] * 10 + (c - '0');
+        }
+    }
+    ++count;
+
+    int code = values[0];
+    if (count >= 3 && values[1] == 5)
+        return terminal_color::palette(static_cast<uint8_t>(values[2]));
+    if (count >= 5 && values[1] == 2)
+        return terminal_color::rgb(static_cast<uint8_t>(values[2]), static_cast<uint8_t>(values[3]),
+                                   static_cast<uint8_t>(values[4]));
+
+    int base = background ? 40 : 30;
+    if (code >= base && code < base + 8)
+        return terminal_color::palette(static_cast<uint8_t>(code - base));
+    if (code >= base + 60 && code < base + 68)
+        return terminal_color::palette(static_cast<uint8_t>(code - base - 60 + 8));
+
+    return terminal_color::default_color;
+}
+
+// Converted colors, direct-mapped by the bytes of the ftxui::Color. Each
+// capturing thread keeps its caches across frames, so once an editor's
+// palette has been seen no cell goes through Color::Print() again; truecolor
+// strings do not fit the small-string buffer and would allocate every time.
+struct color_cache
+{
+    static constexpr size_t k_size = 64;
+
+    struct entry
+    {
+        bool valid = false;
+        ftxui::Color color;
+        uint32_t packed = terminal_color::default_color;
+    };
+    entry entries[k_size];
+
+    uint32_t get(const ftxui::Color &c, bool background)
+    {
+        entry &e = entries[slot(c)];
+        if (!e.valid || !(c == e.color))
+        {
+            e.color = c;
+            e.packed = pack_color(c, background);
+            e.valid = true;
+        }
+        return e.packed;
+    }
+
+    // Color has no public accessors, but its bytes make a fine key; equality
+    // still goes through operator==, so padding can only cost a miss
+    static size_t slot(const ftxui::Color &c)
+    {
+        auto bytes = reinterpret_cast<const unsigned char *>(&c);
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < sizeof(ftxui::Color); ++i)
+        {
+            hash = (hash ^ bytes[i]) * 16777619u;
+        }
+        return (hash ^ (hash >> 16)) & (k_size - 1);
+    }
+};
+
+namespace terminal_color
+{
+
+uint32_t to_rgb(uint32_t color, uint32_t default_rgb)
+{
+    // The 16 base colors as xterm shows them
+    static constexpr uint32_t base[16] = {
+        0x000000, 0xCD0000, 0x00CD00, 0xCDCD00, 0x0000EE, 0xCD00CD, 0x00CDCD, 0xE5E5E5,
+        0x7F7F7F, 0xFF0000, 0x00FF00, 0xFFFF00, 0x5C5CFF, 0xFF00FF, 0x00FFFF, 0xFFFFFF,
+    };
+
+    switch (color & kind_mask)
+    {
+    case rgb_kind:
+        return color & 0xFFFFFFu;
+    case palette_kind:
+        break;
+    default:
+        return default_rgb;
+    }
+
+    uint32_t index = color & 0xFFu;
+    if (index < 16)
+        return base[index];
+
+    if (index < 232)
+    {
+        // 6x6x6 cube
+        index -= 16;
+        auto level = [](uint32_t step) { return step ? 55 + step * 40 : 0; };
+        return (level(index / 36) << 16) | (level(index / 6 % 6) << 8) | level(index % 6);
+    }
+
+    // 24 grays
+    uint32_t gray = 8 + (index - 232) * 10;
+    return (gray << 16) | (gray << 8) | gray;
+}
+
+} // namespace terminal_color
+
+void capture_frame(const ftxui::Screen &screen, terminal_frame &frame, bool colors)
+{
+    frame.resize(screen.dimx(), screen.dimy());
+
+    static thread_local color_cache foreground;
+    static thread_local color_cache background;
+
+    for (int y = 0; y < frame.rows; ++y)
+    {
+        terminal_cell *cells = frame.row(y);
+        for (int x = 0; x < frame.cols; ++x)
+        {
+            const ftxui::Pixel &pixel = screen.PixelAt(x, y);
+            terminal_cell &cell = cells[x];
+
+            cell.codepoint = decode_codepoint(pixel.character);
+            if (colors)
+            {
+                cell.foreground = foreground.get(pixel.foreground_color, false);
+                cell.background = background.get(pixel.background_color, true);
+            }
+            else
+            {
+                cell.foreground = terminal_color::default_color;
+                cell.background = terminal_color::default_color;
+            }
+            cell.attributes = static_cast<uint16_t>(
+                (pixel.bold ? attr_bold : 0) | (pixel.dim ? attr_dim : 0) |
+                (pixel.underlined ? attr_underlined : 0) |
+                (pixel.underlined_double ? attr_underlined_double : 0) |
+                (pixel.blink ? attr_blink : 0) | (pixel.inverted ? attr_inverted : 0) |
+                (pixel.strikethrough ? attr_strikethrough : 0));
+        }
+    }
+}
+
+void diff_frames(const terminal_frame &previous, const terminal_frame &current,
+                 std::vector<damage_span> &damage)
+{
+    if (previous.cols != current.cols || previous.rows != current.rows)
+    {
+        full_damage(current, damage);
+        return;
+    }
+
+    for (int y = 0; y < current.rows; ++y)
+    {
+        const terminal_cell *before = previous.row(y);
+        const terminal_cell *after = current.row(y);
+
+        int x = 0;
+        while (x < current.cols)
+        {
+            if (before[x] == after[x])
+            {
+                ++x;
+                continue;
+            }
+
+            // Extend the span over changes separated by short unchanged gaps
+            int begin = x;
+            int end = x + 1;
+            for (x = end; x < current.cols && x - end < k_damage_merge_gap; ++x)
+            {
+                if (before[x] != after[x])
+                {
+                    end = x + 1;
+                }
+            }
+            x = end;
+
+            damage.push_back({static_cast<uint16_t>(y), static_cast<uint16_t>(begin),
+                              static_cast<uint16_t>(end)});
+        }
+    }
+}
+
+void full_damage(const terminal_frame &frame, std::vector<damage_span> &damage)
+{
+    for (int y = 0; y < frame.rows; ++y)
+    {
+        damage.push_back({static_cast<uint16_t>(y), 0, static_cast<uint16_t>(frame.cols)});
+    }
+}
+
+void append_utf8(std::string &out, uint32_t codepoint)
+{
+    if (codepoint < 0x80)
+    {
+        out.push_back(static_cast<char>(codepoint));
+    }
+    else if (codepoint < 0x800)
+    {
+        out.push_back(static_cast<char>(0xC0 | (codepoint >> 6)));
+        out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+    }
+    else if (codepoint < 0x10000)
+    {
+        out.push_back(static_cast<char>(0xE0 | (codepoint >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+    }
+    else
+    {
+        out.push_back(static_cast<char>(0xF0 | (codepoint >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+    }
+}
+
+void append_row_text(const terminal_frame &frame, int row, int col_begin, int col_end,
+                     std::string &out)
+{
+    const terminal_cell *cells = frame.row(row);
+    for (int x = col_begin; x < col_end; ++x)
+    {
+        if (cells[x].codepoint != 0)
+        {
+            append_utf8(out, cells[x].codepoint);
+        }
+    }
+}
+
+void frame_to_text(const terminal_frame &frame, std::string &out)
+{
+    out.clear();
+    for (int y = 0; y < frame.rows; ++y)
+    {
+        if (y > 0)
+        {
+            out.push_back('\n');
+        }
+        append_row_text(frame, y, 0, frame.cols, out);
+    }
+}
+
+} // namespace ftxui_clap_support
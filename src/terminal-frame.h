@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ftxui {
+class Screen;
+}
+
+namespace ftxui_clap_support {
+
+/**
+ * Packed terminal colors: the top byte selects the kind, the low bytes hold
+ * either a palette index or 0xRRGGBB.
+ */
+namespace terminal_color {
+constexpr uint32_t kind_mask = 0xFF000000u;
+constexpr uint32_t default_color = 0x00000000u;
+constexpr uint32_t palette_kind = 0x01000000u;
+constexpr uint32_t rgb_kind = 0x02000000u;
+
+constexpr uint32_t palette(uint8_t index) { return palette_kind | index; }
+constexpr uint32_t rgb(uint8_t r, uint8_t g, uint8_t b) {
+  return rgb_kind | (uint32_t(r) << 16) | (uint32_t(g) << 8) | b;
+}
+
+// 0xRRGGBB of a packed color; default_color resolves to default_rgb and
+// palette indices to the xterm 256-color palette
+uint32_t to_rgb(uint32_t color, uint32_t default_rgb);
+} // namespace terminal_color
+
+// Cell attribute bits
+enum terminal_attr : uint16_t {
+  attr_bold = 1 << 0,
+  attr_dim = 1 << 1,
+  attr_underlined = 1 << 2,
+  attr_underlined_double = 1 << 3,
+  attr_blink = 1 << 4,
+  attr_inverted = 1 << 5,
+  attr_strikethrough = 1 << 6,
+};
+
+// One character cell. A codepoint of 0 marks the trailing half of a wide
+// character, which backends skip.
+struct terminal_cell {
+  uint32_t codepoint = ' ';
+  uint32_t foreground = terminal_color::default_color;
+  uint32_t background = terminal_color::default_color;
+  uint16_t attributes = 0;
+  uint16_t reserved = 0;
+
+  bool operator==(const terminal_cell &other) const {
+    return codepoint == other.codepoint && foreground == other.foreground &&
+           background == other.background && attributes == other.attributes;
+  }
+  bool operator!=(const terminal_cell &other) const {
+    return !(*this == other);
+  }
+};
+
+// A horizontal run of changed cells, [col_begin, col_end) on one row
+struct damage_span {
+  uint16_t row;
+  uint16_t col_begin;
+  uint16_t col_end;
+};
+
+// Row-major grid of cells
+struct terminal_frame {
+  int cols = 0;
+  int rows = 0;
+  std::vector<terminal_cell> cells;
+
+  void resize(int new_cols, int new_rows) {
+    cols = new_cols;
+    rows = new_rows;
+    cells.resize(static_cast<size_t>(cols) * rows);
+  }
+
+  const terminal_cell *row(int y) const {
+    return cells.data() + static_cast<size_t>(y) * cols;
+  }
+  terminal_cell *row(int y) { return cells.data() + static_cast<size_t>(y) * cols; }
+};
+
+// Copy an FTXUI screen into a cell grid, reusing the grid's storage. Without
+// colors every cell keeps the default colors; attributes are kept.
+void capture_frame(const ftxui::Screen &screen, terminal_frame &frame,
+                   bool colors = true);
+
+// Append to damage the spans where current differs from previous. Frames of
+// different sizes produce full damage.
+void diff_frames(const terminal_frame &previous, const terminal_frame &current,
+                 std::vector<damage_span> &damage);
+
+// Append spans covering every cell of the frame
+void full_damage(const terminal_frame &frame, std::vector<damage_span> &damage);
+
+// Append the UTF-8 encoding of a codepoint
+void append_utf8(std::string &out, uint32_t codepoint);
+
+// Append the text of cells [col_begin, col_end) of a row, skipping the
+// trailing halves of wide characters
+void append_row_text(const terminal_frame &frame, int row, int col_begin,
+                     int col_end, std::string &out);
+
+// Plain text of the whole frame, rows separated by newlines
+void frame_to_text(const terminal_frame &frame, std::string &out);
+
+} // namespace ftxui_clap_support
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+#if defined(__APPLE__)
+#include <dispatch/dispatch.h>
+#elif defined(_WIN32)
+#include <climits>
+#include <windows.h>
+#else
+#include <cerrno>
+#include <ctime>
+#include <semaphore.h>
+
+// sem_clockwait arrived in glibc 2.30
+#if defined(__GLIBC__) &&                                                      \
+    (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 30))
+#define FTXUI_CLAP_HAS_SEM_CLOCKWAIT 1
+#else
+#define FTXUI_CLAP_HAS_SEM_CLOCKWAIT 0
+#endif
+#endif
+
+namespace ftxui_clap_support {
+
+/**
+ * Auto-reset event used to park the render thread until there is work.
+ *
+ * signal() never blocks and may be called from any thread, including the
+ * audio thread. Signals raised before the waiter wakes up collapse into a
+ * single wakeup, so a burst of requests costs one semaphore post.
+ */
+class wakeup_event {
+public:
+  wakeup_event() {
+#if defined(__APPLE__)
+    semaphore_ = dispatch_semaphore_create(0);
+#elif defined(_WIN32)
+    semaphore_ = CreateSemaphore(nullptr, 0, LONG_MAX, nullptr);
+#else
+    sem_init(&semaphore_, 0, 0);
+#endif
+  }
+
+  ~wakeup_event() {
+#if defined(__APPLE__)
+    dispatch_release(semaphore_);
+#elif defined(_WIN32)
+    CloseHandle(semaphore_);
+#else
+    sem_destroy(&semaphore_);
+#endif
+  }
+
+  wakeup_event(const wakeup_event &) = delete;
+  wakeup_event &operator=(const wakeup_event &) = delete;
+
+  // Wake the waiter; only the first signal since the last wakeup posts.
+  // The plain load keeps repeated signals from taking the cache line
+  // exclusively while a wakeup is already pending.
+  void signal() {
+    if (!pending_.load(std::memory_order_relaxed) &&
+        !pending_.exchange(true, std::memory_order_acq_rel)) {
+      post();
+    }
+  }
+
+  // Block until signalled
+  void wait() {
+#if defined(__APPLE__)
+    dispatch_semaphore_wait(semaphore_, DISPATCH_TIME_FOREVER);
+#elif defined(_WIN32)
+    WaitForSingleObject(semaphore_, INFINITE);
+#else
+    while (sem_wait(&semaphore_) != 0 && errno == EINTR) {
+    }
+#endif
+    pending_.store(false, std::memory_order_release);
+  }
+
+  // Block until signalled or until the deadline passes.
+  // Returns true if the event was signalled.
+  bool wait_until(std::chrono::steady_clock::time_point deadline) {
+    auto remaining = deadline - std::chrono::steady_clock::now();
+    if (remaining < std::chrono::steady_clock::duration::zero()) {
+      remaining = std::chrono::steady_clock::duration::zero();
+    }
+    auto remaining_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(remaining)
+            .count();
+
+#if defined(__APPLE__)
+    bool signalled = dispatch_semaphore_wait(
+                         semaphore_, dispatch_time(DISPATCH_TIME_NOW,
+                                                   remaining_ns)) == 0;
+#elif defined(_WIN32)
+    DWORD timeout_ms = static_cast<DWORD>((remaining_ns + 999999) / 1000000);
+    bool signalled = WaitForSingleObject(semaphore_, timeout_ms) ==
+                     WAIT_OBJECT_0;
+#else
+    // sem_clockwait takes a deadline on the monotonic clock, like
+    // steady_clock, so stepping the wall clock neither stalls nor hurries
+    // frame pacing. Older C libraries only have sem_timedwait, which
+    // measures against CLOCK_REALTIME.
+    timespec ts;
+#if FTXUI_CLAP_HAS_SEM_CLOCKWAIT
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+    clock_gettime(CLOCK_REALTIME, &ts);
+#endif
+    ts.tv_sec += static_cast<time_t>(remaining_ns / 1000000000);
+    ts.tv_nsec += static_cast<long>(remaining_ns % 1000000000);
+    if (ts.tv_nsec >= 1000000000) {
+      ts.tv_sec += 1;
+      ts.tv_nsec -= 1000000000;
+    }
+
+    int result;
+#if FTXUI_CLAP_HAS_SEM_CLOCKWAIT
+    while ((result = sem_clockwait(&semaphore_, CLOCK_MONOTONIC, &ts)) != 0 &&
+           errno == EINTR) {
+    }
+#else
+    while ((result = sem_timedwait(&semaphore_, &ts)) != 0 && errno == EINTR) {
+    }
+#endif
+    bool signalled = result == 0;
+#endif
+
+    if (signalled) {
+      pending_.store(false, std::memory_order_release);
+    }
+    return signalled;
+  }
+
+private:
+  void post() {
+#if defined(__APPLE__)
+    dispatch_semaphore_signal(semaphore_);
+#elif defined(_WIN32)
+    ReleaseSemaphore(semaphore_, 1, nullptr);
+#else
+    sem_post(&semaphore_);
+#endif
+  }
+
+  std::atomic<bool> pending_{false};
+
+#if defined(__APPLE__)
+  dispatch_semaphore_t semaphore_;
+#elif defined(_WIN32)
+  HANDLE semaphore_;
+#else
+  sem_t semaphore_;
+#endif
+};
+
+} // namespace ftxui_clap_support
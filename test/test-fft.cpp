@@ -0,0 +1,57 @@
+// Checks fft::forward against a direct DFT
+#include "fft.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace ftxui_clap_support;
+
+int main()
+{
+    const double pi = 3.14159265358979323846;
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> level(-1.0f, 1.0f);
+
+    int failures = 0;
+    for (size_t size : {2, 4, 8, 16, 64, 256, 2048})
+    {
+        std::vector<float> re(size), im(size);
+        std::vector<std::complex<double>> input(size);
+        for (size_t i = 0; i < size; ++i)
+        {
+            re[i] = level(random);
+            im[i] = level(random);
+            input[i] = {re[i], im[i]};
+        }
+
+        fft transform(size);
+        transform.forward(re.data(), im.data());
+
+        // Random input gives outputs around sqrt(size); single-precision
+        // rounding adds up over log2(size) stages
+        double tolerance = 1e-6 * std::sqrt(static_cast<double>(size)) *
+                           std::log2(static_cast<double>(size));
+        double worst = 0.0;
+        for (size_t k = 0; k < size; ++k)
+        {
+            std::complex<double> sum = 0.0;
+            for (size_t i = 0; i < size; ++i)
+            {
+                sum += input[i] * std::polar(1.0, -2.0 * pi * static_cast<double>(k * i % size) /
+                                                      static_cast<double>(size));
+            }
+            worst = std::max(worst, std::abs(sum - std::complex<double>(re[k], im[k])));
+        }
+
+        if (worst > tolerance)
+        {
+            std::printf("fft mismatch: size %zu, error %g, tolerance %g\n", size, worst, tolerance);
+            ++failures;
+        }
+    }
+
+    return failures ? 1 : 0;
+}
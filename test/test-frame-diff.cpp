@@ -0,0 +1,156 @@
+// Checks diff_frames against a cell-by-cell comparison of random frames
+#include "terminal-frame.h"
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace ftxui_clap_support;
+
+// Changes separated by fewer unchanged cells than this share a span
+static constexpr int merge_gap = 2;
+
+static void randomize(terminal_frame &frame, std::mt19937 &random, int percent)
+{
+    std::uniform_int_distribution<int> roll(0, 99);
+    for (terminal_cell &cell : frame.cells)
+    {
+        if (roll(random) < percent)
+        {
+            cell.codepoint = 'a' + roll(random) % 26;
+            cell.foreground = terminal_color::palette(static_cast<uint8_t>(roll(random)));
+        }
+    }
+}
+
+static int check_damage(const terminal_frame &before, const terminal_frame &after,
+                        const std::vector<damage_span> &damage)
+{
+    int failures = 0;
+    std::vector<int> covered(after.cells.size(), 0);
+
+    int last_row = -1;
+    int last_end = 0;
+    for (const damage_span &span : damage)
+    {
+        const terminal_cell *a = before.row(span.row);
+        const terminal_cell *b = after.row(span.row);
+
+        // Spans come in order, start and end on a change and never overlap
+        bool ordered = span.row > last_row || (span.row == last_row && span.col_begin > last_end);
+        bool tight = span.col_begin < span.col_end && span.col_end <= after.cols &&
+                     a[span.col_begin] != b[span.col_begin] &&
+                     a[span.col_end - 1] != b[span.col_end - 1];
+        if ((!ordered || !tight) && failures++ < 10)
+        {
+            std::printf("bad span: row %d, [%d, %d)\n", span.row, span.col_begin, span.col_end);
+        }
+
+        // Neighbouring spans on a row are separated by at least the merge gap
+        if (span.row == last_row && span.col_begin - last_end < merge_gap && failures++ < 10)
+        {
+            std::printf("unmerged spans: row %d, gap [%d, %d)\n", span.row, last_end,
+                        span.col_begin);
+        }
+
+        // And a span never bridges a longer run of unchanged cells
+        int unchanged = 0;
+        for (int x = span.col_begin; x < span.col_end; ++x)
+        {
+            unchanged = a[x] == b[x] ? unchanged + 1 : 0;
+            if (unchanged >= merge_gap && failures++ < 10)
+            {
+                std::printf("overmerged span: row %d, [%d, %d)\n", span.row, span.col_begin,
+                            span.col_end);
+            }
+            covered[static_cast<size_t>(span.row) * after.cols + x] = 1;
+        }
+
+        last_row = span.row;
+        last_end = span.col_end;
+    }
+
+    for (size_t i = 0; i < after.cells.size(); ++i)
+    {
+        if (before.cells[i] != after.cells[i] && !covered[i] && failures++ < 10)
+        {
+            std::printf("missed change: row %zu, col %zu\n", i / after.cols, i % after.cols);
+        }
+    }
+    return failures;
+}
+
+int main()
+{
+    std::mt19937 random(1);
+
+    int failures = 0;
+    for (int cols : {1, 3, 80, 203})
+    {
+        for (int rows : {1, 24})
+        {
+            // From a single change per frame to nearly everything changing
+            for (int percent : {0, 1, 10, 40, 90, 100})
+            {
+                terminal_frame before, after;
+                before.resize(cols, rows);
+                randomize(before, random, 50);
+                after = before;
+                randomize(after, random, percent);
+
+                std::vector<damage_span> damage;
+                diff_frames(before, after, damage);
+                failures += check_damage(before, after, damage);
+
+                if (percent == 0 && !damage.empty() && failures++ < 10)
+                {
+                    std::printf("damage between equal frames: %dx%d\n", cols, rows);
+                }
+            }
+        }
+    }
+
+    // Gaps right at the merge threshold
+    for (int gap = 0; gap <= merge_gap + 2; ++gap)
+    {
+        terminal_frame before, after;
+        before.resize(20, 1);
+        after = before;
+        after.row(0)[4].codepoint = 'x';
+        after.row(0)[5 + gap].codepoint = 'x';
+
+        std::vector<damage_span> damage;
+        diff_frames(before, after, damage);
+        failures += check_damage(before, after, damage);
+
+        size_t expected = gap < merge_gap ? 1 : 2;
+        if (damage.size() != expected && failures++ < 10)
+        {
+            std::printf("gap of %d: %zu spans, expected %zu\n", gap, damage.size(), expected);
+        }
+    }
+
+    // A resize damages the whole new frame
+    {
+        terminal_frame before, after;
+        before.resize(10, 4);
+        after.resize(12, 3);
+
+        std::vector<damage_span> damage;
+        diff_frames(before, after, damage);
+        bool full = damage.size() == 3;
+        for (size_t y = 0; full && y < damage.size(); ++y)
+        {
+            full = damage[y].row == y && damage[y].col_begin == 0 && damage[y].col_end == 12;
+        }
+        if (!full && failures++ < 10)
+        {
+            std::printf("resize: %zu spans, expected full damage\n", damage.size());
+        }
+    }
+
+    if (failures)
+    {
+        std::printf("%d failures\n", failures);
+    }
+    return failures ? 1 : 0;
+}
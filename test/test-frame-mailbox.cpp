@@ -0,0 +1,217 @@
+// Checks ftxui_clap_triple_buffer and the frame mailbox built on it: values
+// are taken newest first, never twice and never torn, and replaying the
+// published damage onto the presented frame reproduces every new frame
+#include "frame-mailbox.h"
+#include <cstdio>
+#include <random>
+#include <thread>
+
+using namespace ftxui_clap_support;
+
+static constexpr int cols = 40;
+static constexpr int rows = 8;
+
+// A value large enough that a torn copy would show
+struct stamped
+{
+    uint64_t words[16] = {};
+
+    void fill(uint64_t value)
+    {
+        for (uint64_t &word : words)
+        {
+            word = value;
+        }
+    }
+
+    bool consistent() const
+    {
+        for (uint64_t word : words)
+        {
+            if (word != words[0])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+static int check_single_thread()
+{
+    int failures = 0;
+    ftxui_clap_triple_buffer<int> buffer;
+
+    if ((buffer.take() || buffer.lastPublished()) && failures++ < 10)
+    {
+        std::printf("value before the first publish\n");
+    }
+
+    buffer.back() = 1;
+    buffer.publish();
+    const int *value = buffer.take();
+    if ((!value || *value != 1 || !buffer.lastPublished() || *buffer.lastPublished() != 1) &&
+        failures++ < 10)
+    {
+        std::printf("first publish not taken\n");
+    }
+    if (buffer.take() && failures++ < 10)
+    {
+        std::printf("value taken twice\n");
+    }
+
+    // Values published before the consumer got to them are replaced
+    for (int i = 2; i <= 5; ++i)
+    {
+        buffer.back() = i;
+        buffer.publish();
+    }
+    value = buffer.take();
+    if ((!value || *value != 5) && failures++ < 10)
+    {
+        std::printf("took %d, expected the newest value 5\n", value ? *value : -1);
+    }
+
+    // The taken value stays put while the producer keeps publishing
+    buffer.back() = 6;
+    buffer.publish();
+    buffer.back() = 7;
+    buffer.publish();
+    if (*value != 5 && failures++ < 10)
+    {
+        std::printf("taken value overwritten by the producer\n");
+    }
+    return failures;
+}
+
+static int check_two_threads()
+{
+    static constexpr uint64_t count = 200000;
+
+    int failures = 0;
+    ftxui_clap_triple_buffer<stamped> buffer;
+
+    std::thread producer([&] {
+        for (uint64_t i = 1; i <= count; ++i)
+        {
+            buffer.back().fill(i);
+            buffer.publish();
+        }
+    });
+
+    uint64_t last = 0;
+    while (last != count)
+    {
+        const stamped *value = buffer.take();
+        if (!value)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        if ((!value->consistent() || value->words[0] <= last) && failures++ < 10)
+        {
+            std::printf("took %llu after %llu\n",
+                        static_cast<unsigned long long>(value->words[0]),
+                        static_cast<unsigned long long>(last));
+        }
+        last = value->words[0];
+    }
+
+    producer.join();
+    return failures;
+}
+
+// The render stage publishes frames with their damage against the previous
+// publish; the presenter repaints fully after a gap, otherwise only the
+// damaged spans
+static int check_frame_mailbox()
+{
+    static constexpr uint64_t count = 20000;
+
+    int failures = 0;
+    frame_mailbox mailbox;
+
+    std::thread render([&] {
+        std::mt19937 random(1);
+        std::uniform_int_distribution<int> cell(0, cols * rows - 1);
+
+        terminal_frame next;
+        next.resize(cols, rows);
+        for (uint64_t sequence = 1; sequence <= count; ++sequence)
+        {
+            // A few cells change per frame
+            for (int i = 0; i < 3; ++i)
+            {
+                next.cells[cell(random)].codepoint = 'a' + sequence % 26;
+            }
+            next.cells[0].codepoint = static_cast<uint32_t>(sequence);
+
+            mailbox_frame &slot = mailbox.back();
+            slot.frame = next;
+            slot.damage.clear();
+            const mailbox_frame *previous = mailbox.lastPublished();
+            if (previous)
+            {
+                diff_frames(previous->frame, slot.frame, slot.damage);
+            }
+            else
+            {
+                full_damage(slot.frame, slot.damage);
+            }
+            slot.sequence = sequence;
+            mailbox.publish();
+        }
+    });
+
+    terminal_frame presented;
+    presented.resize(cols, rows);
+    uint64_t presented_sequence = 0;
+    while (presented_sequence != count)
+    {
+        const mailbox_frame *published = mailbox.take();
+        if (!published)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        if (published->sequence != presented_sequence + 1)
+        {
+            presented = published->frame;
+        }
+        else
+        {
+            for (const damage_span &span : published->damage)
+            {
+                for (int x = span.col_begin; x < span.col_end; ++x)
+                {
+                    presented.row(span.row)[x] = published->frame.row(span.row)[x];
+                }
+            }
+        }
+
+        bool equal = presented.cells == published->frame.cells &&
+                     published->frame.cells[0].codepoint == published->sequence;
+        if (!equal && failures++ < 10)
+        {
+            std::printf("frame %llu differs after %s\n",
+                        static_cast<unsigned long long>(published->sequence),
+                        published->sequence == presented_sequence + 1 ? "damage" : "repaint");
+        }
+        presented_sequence = published->sequence;
+    }
+
+    render.join();
+    return failures;
+}
+
+int main()
+{
+    int failures = check_single_thread() + check_two_threads() + check_frame_mailbox();
+    if (failures)
+    {
+        std::printf("%d failures\n", failures);
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,139 @@
+// Checks mpsc_ring against a plain FIFO from one thread, and for loss,
+// duplication and per-producer order with concurrent producers
+#include "mpsc-ring.h"
+#include <cstdio>
+#include <deque>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace ftxui_clap_support;
+
+static int check_single_thread()
+{
+    int failures = 0;
+    mpsc_ring<int, 8> ring;
+    std::deque<int> reference;
+
+    int value = 0;
+    if (ring.pop(value) && failures++ < 10)
+    {
+        std::printf("pop from an empty ring\n");
+    }
+
+    // Random pushes and pops wrap around the ring many times and run into
+    // both the full and the empty end
+    std::mt19937 random(1);
+    std::uniform_int_distribution<int> roll(0, 99);
+    int next = 0;
+    for (int step = 0; step < 100000; ++step)
+    {
+        if (roll(random) < 55)
+        {
+            bool pushed = ring.try_push(next);
+            if (pushed != (reference.size() < 8) && failures++ < 10)
+            {
+                std::printf("push with %zu queued: %s\n", reference.size(),
+                            pushed ? "accepted" : "rejected");
+            }
+            if (pushed)
+            {
+                reference.push_back(next);
+            }
+            ++next;
+        }
+        else
+        {
+            bool popped = ring.pop(value);
+            bool correct = popped == !reference.empty() && (!popped || value == reference.front());
+            if (!correct && failures++ < 10)
+            {
+                std::printf("pop with %zu queued: %s %d\n", reference.size(),
+                            popped ? "got" : "nothing", value);
+            }
+            if (popped && !reference.empty())
+            {
+                reference.pop_front();
+            }
+        }
+    }
+    return failures;
+}
+
+static int check_producers(int producers)
+{
+    static constexpr uint32_t count = 100000;
+
+    struct element
+    {
+        uint32_t producer;
+        uint32_t sequence;
+    };
+
+    int failures = 0;
+    mpsc_ring<element, 64> ring;
+
+    // Producers retry rejected pushes, so every element must arrive, in the
+    // order its producer pushed it
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p)
+    {
+        threads.emplace_back([&ring, p] {
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                while (!ring.try_push({static_cast<uint32_t>(p), i}))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<uint32_t> expected(producers, 0);
+    uint64_t remaining = uint64_t(count) * producers;
+    while (remaining)
+    {
+        element e;
+        if (!ring.pop(e))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        if ((e.producer >= static_cast<uint32_t>(producers) ||
+             e.sequence != expected[e.producer]) &&
+            failures++ < 10)
+        {
+            std::printf("%d producers: element %u from producer %u, expected %u\n", producers,
+                        e.sequence, e.producer,
+                        e.producer < static_cast<uint32_t>(producers) ? expected[e.producer] : 0);
+        }
+        if (e.producer < static_cast<uint32_t>(producers))
+        {
+            expected[e.producer] = e.sequence + 1;
+        }
+        --remaining;
+    }
+
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    element extra;
+    if (ring.pop(extra) && failures++ < 10)
+    {
+        std::printf("%d producers: element left over\n", producers);
+    }
+    return failures;
+}
+
+int main()
+{
+    int failures = check_single_thread() + check_producers(1) + check_producers(4);
+    if (failures)
+    {
+        std::printf("%d failures\n", failures);
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,153 @@
+// Checks parameter_table against a std::map of the latest values from one
+// thread, and that a concurrent drain never loses or reorders the newest
+// value of a parameter
+#include "parameter-table.h"
+#include <atomic>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace ftxui_clap_support;
+
+static int check_single_thread()
+{
+    int failures = 0;
+    parameter_table table(100);
+    std::map<uint32_t, double> reference;
+
+    auto drain = [&](std::map<uint32_t, double> &seen) {
+        seen.clear();
+        return table.drain([&](uint32_t id, double value) {
+            if (seen.count(id) && failures++ < 10)
+            {
+                std::printf("parameter %u drained twice\n", id);
+            }
+            seen[id] = value;
+        });
+    };
+
+    std::map<uint32_t, double> seen;
+    if (drain(seen) && failures++ < 10)
+    {
+        std::printf("drain of an empty table reported changes\n");
+    }
+
+    // Sparse, large ids, each stored several times between two drains
+    std::mt19937 random(1);
+    std::vector<uint32_t> ids;
+    for (int i = 0; i < 100; ++i)
+    {
+        ids.push_back(random() % 0xFFFFFFF0u);
+    }
+
+    std::uniform_int_distribution<size_t> pick(0, ids.size() - 1);
+    for (int round = 0; round < 200; ++round)
+    {
+        reference.clear();
+        for (int i = 0; i < 50; ++i)
+        {
+            uint32_t id = ids[pick(random)];
+            double value = round * 1000.0 + i;
+            if (!table.store(id, value) && failures++ < 10)
+            {
+                std::printf("store of parameter %u rejected\n", id);
+            }
+            reference[id] = value;
+        }
+
+        bool changed = drain(seen);
+        if ((!changed || seen != reference) && failures++ < 10)
+        {
+            std::printf("round %d: drained %zu parameters, expected %zu\n", round, seen.size(),
+                        reference.size());
+        }
+        if (drain(seen) && failures++ < 10)
+        {
+            std::printf("round %d: second drain reported changes\n", round);
+        }
+    }
+
+    // New ids beyond the capacity are rejected, known ones still accepted
+    parameter_table small(64);
+    int stored = 0;
+    for (uint32_t id = 0; id < 1000; ++id)
+    {
+        stored += small.store(id * 7919u, 1.0);
+    }
+    if ((stored != 64 || !small.store(0, 2.0)) && failures++ < 10)
+    {
+        std::printf("%d of 1000 ids stored in a table of 64\n", stored);
+    }
+    return failures;
+}
+
+static int check_two_threads()
+{
+    static constexpr uint32_t parameters = 32;
+    static constexpr int rounds = 20000;
+
+    int failures = 0;
+    parameter_table table(parameters);
+
+    // Every parameter is stored with increasing values, so a drain may skip
+    // values but must never go backwards
+    std::atomic<bool> finished{false};
+    std::thread producer([&] {
+        for (int round = 1; round <= rounds; ++round)
+        {
+            for (uint32_t id = 0; id < parameters; ++id)
+            {
+                table.store(id * 1000003u, round);
+            }
+        }
+        finished.store(true, std::memory_order_release);
+    });
+
+    std::vector<double> latest(parameters, 0.0);
+    auto drain = [&] {
+        table.drain([&](uint32_t id, double value) {
+            uint32_t index = id / 1000003u;
+            if ((id % 1000003u || index >= parameters || value < latest[index]) &&
+                failures++ < 10)
+            {
+                std::printf("parameter %u went from %g to %g\n", id,
+                            index < parameters ? latest[index] : 0.0, value);
+            }
+            if (index < parameters)
+            {
+                latest[index] = value;
+            }
+        });
+    };
+
+    while (!finished.load(std::memory_order_acquire))
+    {
+        drain();
+        std::this_thread::yield();
+    }
+    producer.join();
+    drain();
+
+    // Whatever the interleaving, the final values arrive
+    for (uint32_t index = 0; index < parameters; ++index)
+    {
+        if (latest[index] != rounds && failures++ < 10)
+        {
+            std::printf("parameter %u ended at %g, expected %d\n", index * 1000003u,
+                        latest[index], rounds);
+        }
+    }
+    return failures;
+}
+
+int main()
+{
+    int failures = check_single_thread() + check_two_threads();
+    if (failures)
+    {
+        std::printf("%d failures\n", failures);
+    }
+    return failures ? 1 : 0;
+}
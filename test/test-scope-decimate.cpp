@@ -0,0 +1,58 @@
+// Checks ftxui_clap_decimateMinMax against a naive per-column min/max
+#include "ftxui-clap-support/ftxui-clap-scope.h"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+int main()
+{
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> level(-1.0f, 1.0f);
+
+    int failures = 0;
+    for (uint32_t count : {1u, 3u, 17u, 2048u, 4099u})
+    {
+        std::vector<float> samples(count);
+        for (float &sample : samples)
+        {
+            sample = level(random);
+        }
+
+        // Fewer, equal and more columns than samples
+        for (uint32_t columns : {1u, 7u, 120u, 241u, 2048u, 5000u})
+        {
+            std::vector<float> mins(columns), maxs(columns);
+            ftxui_clap_decimateMinMax(samples.data(), count, columns, mins.data(), maxs.data());
+
+            for (uint32_t c = 0; c < columns; ++c)
+            {
+                uint32_t begin = static_cast<uint32_t>(uint64_t(c) * count / columns);
+                uint32_t end = static_cast<uint32_t>(uint64_t(c + 1) * count / columns);
+
+                // An empty column takes the nearest sample
+                float lo = samples[std::min(begin, count - 1)];
+                float hi = lo;
+                for (uint32_t i = begin; i < end; ++i)
+                {
+                    lo = std::min(lo, samples[i]);
+                    hi = std::max(hi, samples[i]);
+                }
+
+                if ((lo != mins[c] || hi != maxs[c]) && failures++ < 10)
+                {
+                    std::printf("decimate mismatch: %u samples, %u columns, column %u: "
+                                "[%g, %g], expected [%g, %g]\n",
+                                count, columns, c, mins[c], maxs[c], lo, hi);
+                }
+            }
+        }
+    }
+
+    if (failures)
+    {
+        std::printf("%d mismatched columns\n", failures);
+        return 1;
+    }
+    return 0;
+}